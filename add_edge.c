@@ -9,7 +9,7 @@
 #include "game_ext.h"
 #include "game_struct.h"
 
-uint _code[NB_SHAPES][NB_DIRS] = {
+const uint _code[NB_SHAPES][NB_DIRS] = {
     {0b0000, 0b0000, 0b0000, 0b0000},  // EMPTY {" ", " ", " ", " "}
     {0b1000, 0b0100, 0b0010, 0b0001},  // ENDPOINT {"^", ">", "v", "<"},
     {0b1010, 0b0101, 0b1010, 0b0101},  // SEGMENT {"|", "-", "|", "-"},
@@ -18,20 +18,36 @@ uint _code[NB_SHAPES][NB_DIRS] = {
     {0b1111, 0b1111, 0b1111, 0b1111}   // CROSS {"+", "+", "+", "+"}
 };
 
+const shape _mask_shape[16] = {
+    EMPTY,    ENDPOINT, ENDPOINT, CORNER,  // 0000 0001 0010 0011
+    ENDPOINT, SEGMENT,  CORNER,   TEE,     // 0100 0101 0110 0111
+    ENDPOINT, CORNER,   SEGMENT,  TEE,     // 1000 1001 1010 1011
+    CORNER,   TEE,      TEE,      CROSS    // 1100 1101 1110 1111
+};
+
+const direction _mask_orientation[16] = {
+    NORTH, WEST,  SOUTH, SOUTH,  // 0000 0001 0010 0011
+    EAST,  EAST,  EAST,  SOUTH,  // 0100 0101 0110 0111
+    NORTH, WEST,  NORTH, WEST,   // 1000 1001 1010 1011
+    NORTH, NORTH, EAST,  NORTH   // 1100 1101 1110 1111
+};
+
 uint _encode_shape(shape s, direction o) { return _code[s][o]; }
 
 bool _decode_shape(uint code, shape *s, direction *o) {
   assert(code >= 0 && code < 16);
   assert(s);
   assert(o);
-  for (int i = 0; i < NB_SHAPES; i++)
-    for (int j = 0; j < NB_DIRS; j++)
-      if (code == _code[i][j]) {
-        *s = i;
-        *o = j;
-        return true;
-      }
-  return false;
+  *s = _mask_shape[code];
+  *o = _mask_orientation[code];
+  return true;
+}
+
+/* add an half-edge to the square at @p index, in the space of masks */
+static void _add_half_edge_at(game g, size_t index, direction d) {
+  uint code = CELL_MASK(g->cells[index]);
+  assert((code & DIR_BIT(d)) == 0);  // no half-edge in the direction d yet
+  _game_set_cell(g, index, _cell_from_mask(code | DIR_BIT(d)));
 }
 
 void _add_half_edge(game g, uint i, uint j, direction d) {
@@ -40,38 +56,32 @@ void _add_half_edge(game g, uint i, uint j, direction d) {
   assert(j < game_nb_cols(g));
   assert(d < NB_DIRS);
 
-  shape s = game_get_piece_shape(g, i, j);
-  direction o = game_get_piece_orientation(g, i, j);
-  uint code = _encode_shape(s, o);
-  uint mask = 0b1000 >> d;     // mask with half-edge in the direction d
-  assert((code & mask) == 0);  // check there is no half-edge in the direction d
-  uint newcode = code | mask;  // add the half-edge in the direction d
-  shape news;
-  direction newo;
-  bool ok = _decode_shape(newcode, &news, &newo);
-  assert(ok);
-  game_set_piece_shape(g, i, j, news);
-  game_set_piece_orientation(g, i, j, newo);
+  _add_half_edge_at(g, _game_index(g, i, j), d);
 }
 
-bool _add_edge(game g, uint i, uint j, direction d) {
+bool _add_edge_at(game g, size_t index, direction d) {
   assert(g);
-  assert(i < game_nb_rows(g));
-  assert(j < game_nb_cols(g));
+  assert(index < _game_size(g));
   assert(d < NB_DIRS);
 
-  uint nexti, nextj;
-  bool next = game_get_ajacent_square(g, i, j, d, &nexti, &nextj);
-  if (!next) return false;
+  size_t next = _game_neighbor(g, index, d);
+  if (next == NO_NEIGHBOR) return false;
 
   // check if the two half-edges are free
-  bool he = game_has_half_edge(g, i, j, d);
-  if (he) return false;
-  bool next_he = game_has_half_edge(g, nexti, nextj, OPPOSITE_DIR(d));
-  if (next_he) return false;
+  if (_game_has_half_edge(g, index, d)) return false;
+  if (_game_has_half_edge(g, next, OPPOSITE_DIR(d))) return false;
 
-  _add_half_edge(g, i, j, d);
-  _add_half_edge(g, nexti, nextj, OPPOSITE_DIR(d));
+  _add_half_edge_at(g, index, d);
+  _add_half_edge_at(g, next, OPPOSITE_DIR(d));
 
   return true;
 }
+
+bool _add_edge(game g, uint i, uint j, direction d) {
+  assert(g);
+  assert(i < game_nb_rows(g));
+  assert(j < game_nb_cols(g));
+  assert(d < NB_DIRS);
+
+  return _add_edge_at(g, _game_index(g, i, j), d);
+}
@@ -59,5 +59,10 @@ void _add_half_edge(game g, uint i, uint j, direction d);
  */
 bool _add_edge(game g, uint i, uint j, direction d);
 
+/* ************************************************************************** */
+
+/** same as _add_edge(), for the square stored at @p index */
+bool _add_edge_at(game g, size_t index, direction d);
+
 /* ************************************************************************** */
 #endif
\ No newline at end of file
@@ -8,91 +8,185 @@
 
 #include "game_aux.h"
 #include "game_ext.h"
+#include "game_inline.h"
+#include "game_log.h"
 #include "game_struct.h"
 #include "queue.h"
 
 typedef struct game_s *game;
 
-game game_new_empty(void) {
-  game g = malloc(sizeof(struct game_s));
-  if (g == NULL) {
-    return NULL;
+// Vrai si la demi-arête (index, d) existe mais n'a pas de demi-arête en face
+static inline bool _is_mismatch(cgame g, size_t index, direction d) {
+  return _game_has_half_edge(g, index, d) &&
+         _game_check_edge(g, index, d) != MATCH;
+}
+
+// Nombre de demi-arêtes non appariées qui dépendent de la case index : les
+// siennes et celles de ses voisins tournées vers elle
+static uint _local_mismatches(cgame g, size_t index) {
+  uint count = 0;
+  for (direction d = 0; d < NB_DIRS; d++) {
+    count += _is_mismatch(g, index, d);
+    size_t next = _game_neighbor(g, index, d);
+    // Une case voisine d'elle-même (grille de largeur 1 avec wrapping) est
+    // déjà comptée ci-dessus
+    if (next != NO_NEIGHBOR && next != index) {
+      count += _is_mismatch(g, next, opposite_direction(d));
+    }
   }
+  return count;
+}
 
-  // Initialise les dimensions
-  g->nb_cols = 5;
-  g->nb_rows = 5;
+void _game_set_cell(game g, size_t index, cell c) {
+  uint old_mask = CELL_MASK(g->cells[index]);
+  uint old_links = (g->tracker != NULL) ? _game_links(g, index) : 0;
 
-  // Initialise les tableaux des formes et orientations
-  g->shapes = malloc(g->nb_cols * g->nb_rows * sizeof(shape));
-  g->orientations = malloc(g->nb_cols * g->nb_rows * sizeof(direction));
-  if (g->shapes == NULL || g->orientations == NULL) {
-    game_delete(g);
-    return NULL;
-  }
+  // Seules les 4 arêtes de la case modifiée peuvent changer de statut
+  g->nb_mismatches -= _local_mismatches(g, index);
+  g->hash ^= _zobrist(index, g->cells[index]) ^ _zobrist(index, c);
+  g->cells[index] = c;
+  g->nb_mismatches += _local_mismatches(g, index);
+  g->generation++;
 
-  for (uint i = 0; i < g->nb_cols * g->nb_rows; i++) {
-    g->shapes[i] = EMPTY;
-    g->orientations[i] = NORTH;
+  // Le prochain instantané ne recopie que les morceaux modifiés
+  if (g->dirty != NULL) {
+    g->dirty[index / CHUNK_SIZE] = true;
   }
 
-  // Alloue et initialise les piles pour undo/redo
-  g->undo = queue_new();
-  g->redo = queue_new();
-  if (g->undo == NULL || g->redo == NULL) {
-    game_delete(g);
-    return NULL;
+  if (g->tracker != NULL) {
+    tracker_update(g->tracker, g, (uint)index, old_mask, old_links,
+                   _game_links(g, index));
   }
+}
 
-  return g;
+void _game_refresh(game g) {
+  g->generation++;
+  g->nb_mismatches = _game_count_mismatches(g);
+  g->hash = 0;
+  for (size_t index = 0; index < _game_size(g); index++) {
+    g->hash ^= _zobrist(index, g->cells[index]);
+  }
+  if (g->tracker != NULL) {
+    tracker_rebuild(g->tracker, g);
+  }
+  if (g->dirty != NULL) {
+    memset(g->dirty, true, _game_nb_chunks(g) * sizeof(bool));
+  }
 }
 
-game game_new(shape *shapes, direction *orientations) {
-  game g = game_new_empty();
-  if (g == NULL) {
-    return NULL;
+void _game_push_record(game g, size_t index, uint turns, bool linked) {
+  // Créer les piles undo et redo au premier coup
+  if (g->undo == NULL) {
+    g->undo = queue_new();
+    g->redo = queue_new();
+    if (g->undo == NULL || g->redo == NULL) {
+      GAME_LOG(GAME_LOG_ERROR, "Failed to initialize undo or redo stacks");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  record *r = malloc(sizeof(record));
+  if (r == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to record move for undo stack");
+    exit(EXIT_FAILURE);
   }
+  r->index = index;
+  r->turns = turns;
+  r->linked = linked;
+  r->kind = RECORD_MOVE;
+  queue_push_head(g->undo, r);
 
-  // Initialise les tableaux des formes et orientations avec les valeurs données
-  for (uint i = 0; i < g->nb_cols * g->nb_rows; i++) {
-    g->shapes[i] = (shapes != NULL) ? shapes[i] : EMPTY;
-    g->orientations[i] = (orientations != NULL) ? orientations[i] : NORTH;
+  // Vider la pile redo car un nouveau coup a été joué
+  queue_clear_full(g->redo, free);
+
+  // Un groupe n'est borné qu'une fois fermé, par game_play_moves
+  if (!linked) {
+    _game_trim_history(g, 1);
   }
+}
 
-  return g;
+void _game_trim_history(game g, size_t keep) {
+  // Oublier les coups les plus anciens au-delà de la limite, en O(1) chacun.
+  // Un groupe de coups est oublié en entier, et les keep coups du dernier
+  // groupe restent annulables
+  while (g->history_max > 0 &&
+         (uint)queue_length(g->undo) > g->history_max &&
+         (size_t)queue_length(g->undo) > keep) {
+    record *old = queue_pop_tail(g->undo);
+    while (old->linked && !queue_is_empty(g->undo)) {
+      free(old);
+      old = queue_pop_tail(g->undo);
+    }
+    free(old);
+  }
 }
 
-game game_copy(cgame g) {
-  if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
-    exit(EXIT_FAILURE);
+record *_game_write_begin(game g, size_t index, bool whole) {
+  // Sans coup à annuler, l'écriture n'est pas enregistrée : aucune annulation
+  // ne peut revenir avant elle
+  if (g->undo == NULL || queue_is_empty(g->undo)) {
+    return NULL;
   }
 
-  shape *shapes = malloc((game_nb_rows(g) * game_nb_cols(g)) * sizeof(shape));
-  if (shapes == NULL) {
-    fprintf(stderr, "Memory allocation failed\n");
+  size_t count = whole ? _game_size(g) : 1;
+  record *r = malloc(sizeof(record) + 2 * count * sizeof(cell));
+  if (r == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to record write for undo stack");
     exit(EXIT_FAILURE);
   }
+  r->index = whole ? 0 : index;
+  r->turns = 0;
+  r->kind = whole ? RECORD_GRID : RECORD_SQUARE;
+  memcpy(r->cells, g->cells + r->index, count * sizeof(cell));
+  return r;
+}
 
-  direction *orientations =
-      malloc((game_nb_rows(g) * game_nb_cols(g)) * sizeof(direction));
-  if (orientations == NULL) {
-    free(shapes);
-    fprintf(stderr, "Memory allocation failed\n");
-    exit(EXIT_FAILURE);
+void _game_write_end(game g, record *r) {
+  if (r == NULL) {
+    return;
   }
 
-  // Copie les formes et orientations du jeu existant dans le nouveau jeu
-  for (uint i = 0; i < game_nb_rows(g) * game_nb_cols(g); i++) {
-    shapes[i] = g->shapes[i];
-    orientations[i] = g->orientations[i];
+  size_t count = (r->kind == RECORD_GRID) ? _game_size(g) : 1;
+  memcpy(r->cells + count, g->cells + r->index, count * sizeof(cell));
+  if (memcmp(r->cells, r->cells + count, count * sizeof(cell)) == 0) {
+    free(r);  // Rien n'a changé
+    return;
+  }
+
+  // L'écriture rejoint la dernière entrée de l'historique, comme lorsque
+  // l'annulation restaurait une copie complète du jeu d'avant le dernier coup.
+  // La pile redo est gardée
+  ((record *)queue_peek_head(g->undo))->linked = true;
+  r->linked = false;
+  queue_push_head(g->undo, r);
+}
+
+void _game_clear_history(game g) {
+  if (g->undo != NULL) {
+    queue_clear_full(g->undo, free);
+    queue_clear_full(g->redo, free);
   }
+}
 
-  // Créer un nouveau jeu avec les mêmes caractéristiques que l'original
-  game new_game = game_new_ext(game_nb_rows(g), game_nb_cols(g), shapes,
-                               orientations, game_is_wrapping(g));
-  free(shapes);
-  free(orientations);
+game game_new_empty(void) { return game_new_empty_ext(5, 5, false); }
+
+game game_new(shape *shapes, direction *orientations) {
+  return game_new_ext(5, 5, shapes, orientations, false);
+}
+
+game game_copy(cgame g) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  // Créer un nouveau jeu avec les mêmes caractéristiques que l'original, qui
+  // partage sa table des voisins
+  game new_game = _game_new_shared(g);
+
+  // Copie les cases (forme et orientation) du jeu existant en un bloc
+  game_copy_into(new_game, g);
+  new_game->history_max = g->history_max;
   return new_game;
 }
 
@@ -103,24 +197,24 @@ bool game_equal(cgame g1, cgame g2, bool ignore_orientation) {
     return false;
   }
 
-  if (g1->shapes == NULL || g2->shapes == NULL) {
-    fprintf(stderr, "Shapes are not allocated in one of the games.\n");
-    return false;
-  }
-
-  if (!ignore_orientation &&
-      (g1->orientations == NULL || g2->orientations == NULL)) {
-    fprintf(stderr, "Orientations are not allocated in one of the games.\n");
+  if (g1->cells == NULL || g2->cells == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Cells are not allocated in one of the games.");
     return false;
   }
 
-  // Compare les formes et orientations pour chaque case du jeu
-  for (uint i = 0; i < game_nb_cols(g1) * game_nb_rows(g1); i++) {
-    if (g1->shapes[i] != g2->shapes[i]) {
+  size_t total_size = _game_size(g1);
+  if (!ignore_orientation) {
+    // Deux jeux égaux ont la même empreinte : rejet immédiat sinon
+    if (g1->hash != g2->hash) {
       return false;
     }
+    // La forme et l'orientation sont codées dans le même octet
+    return memcmp(g1->cells, g2->cells, total_size * sizeof(cell)) == 0;
+  }
 
-    if (!ignore_orientation && g1->orientations[i] != g2->orientations[i]) {
+  // Compare seulement les formes pour chaque case du jeu
+  for (size_t i = 0; i < total_size; i++) {
+    if (_cell_shape(g1->cells[i]) != _cell_shape(g2->cells[i])) {
       return false;
     }
   }
@@ -130,156 +224,132 @@ bool game_equal(cgame g1, cgame g2, bool ignore_orientation) {
 
 void game_delete(game g) {
   if (g == NULL) {
-    fprintf(stderr, "Pointeur non valide\n");
+    GAME_LOG(GAME_LOG_ERROR, "Pointeur non valide");
     exit(EXIT_FAILURE);
   }
 
   if (g->undo != NULL) {
-    queue_free_full(g->undo, (void (*)(void *))game_delete);
+    queue_free_full(g->undo, free);
     g->undo = NULL;
   }
 
   if (g->redo != NULL) {
-    queue_free_full(g->redo, (void (*)(void *))game_delete);
+    queue_free_full(g->redo, free);
     g->redo = NULL;
   }
 
-  if (g->shapes != NULL) {
-    free(g->shapes);
-    g->shapes = NULL;
-  }
+  tracker_free(g->tracker);
+  g->tracker = NULL;
 
-  if (g->orientations != NULL) {
-    free(g->orientations);
-    g->orientations = NULL;
-  }
+  _layout_release(g->layout);
+  g->layout = NULL;
 
-  free(g);
+  _snapshot_release(g->base);
+  g->base = NULL;
+  free(g->dirty);
+  g->dirty = NULL;
+
+  // Les cases sont dans le même bloc que la structure, qui appartient à
+  // l'appelant s'il l'a fourni
+  if (g->owned) {
+    free(g);
+  }
 }
 
 void game_set_piece_shape(game g, uint i, uint j, shape s) {
   assert(g != NULL);
   assert(i < g->nb_rows);
   assert(j < g->nb_cols);
-  g->shapes[i * g->nb_cols + j] = s;
+  size_t index = _game_index(g, i, j);
+  record *r = _game_write_begin(g, index, false);
+  _game_set_cell(g, index, _cell_encode(s, CELL_ORIENTATION(g->cells[index])));
+  _game_write_end(g, r);
 }
 
 void game_set_piece_orientation(game g, uint i, uint j, direction o) {
   assert(g != NULL);
   assert(i < g->nb_rows);
   assert(j < g->nb_cols);
-  g->orientations[i * g->nb_cols + j] = o;
+  size_t index = _game_index(g, i, j);
+  record *r = _game_write_begin(g, index, false);
+  _game_set_cell(g, index, _cell_encode(_cell_shape(g->cells[index]), o));
+  _game_write_end(g, r);
 }
 
 shape game_get_piece_shape(cgame g, uint i, uint j) {
   assert(g != NULL);
   assert(i < g->nb_rows);
   assert(j < g->nb_cols);
-  return g->shapes[i * g->nb_cols + j];
+  return _game_get_piece_shape(g, i, j);
 }
 
 direction game_get_piece_orientation(cgame g, uint i, uint j) {
   assert(g != NULL);
   assert(i < g->nb_rows);
   assert(j < g->nb_cols);
-  return g->orientations[i * g->nb_cols + j];
+  return _game_get_piece_orientation(g, i, j);
 }
 
 void game_play_move(game g, uint i, uint j, int nb_quarter_turns) {
   if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
     exit(EXIT_FAILURE);
   }
 
   if (i >= g->nb_rows || j >= g->nb_cols) {
-    fprintf(stderr, "Out-of-bounds index\n");
+    GAME_LOG(GAME_LOG_ERROR, "Out-of-bounds index");
     exit(EXIT_FAILURE);
   }
 
-  uint index = i * g->nb_cols + j;
+  size_t index = _game_index(g, i, j);
 
-  if (g->shapes[index] == EMPTY) {
-    fprintf(stderr, "EMPTY piece at (%u, %u), no changes made.\n", i, j);
+  if (CELL_MASK(g->cells[index]) == 0) {
+    GAME_LOG(GAME_LOG_WARNING, "EMPTY piece at (%u, %u), no changes made.", i,
+             j);
     return;
   }
 
-  // Sauvegarder l'état actuel dans la pile undo
-  if (g->undo == NULL) {
-    fprintf(stderr, "Undo stack not initialized\n");
-    exit(EXIT_FAILURE);
-  }
+  // Le coup est enregistré sous forme de rotation, pas de copie du jeu. Le
+  // masque corrige aussi les rotations négatives
+  uint turns = nb_quarter_turns & 0x03;
+  _game_push_record(g, index, turns, false);
 
-  game copy = game_copy(g);
-  if (copy == NULL) {
-    fprintf(stderr, "Failed to copy game for undo stack\n");
-    exit(EXIT_FAILURE);
-  }
-  queue_push_head(g->undo, copy);
-
-  while (!queue_is_empty(g->redo)) {
-    game redo_game = queue_pop_head(g->redo);
-    game_delete(redo_game);
-  }
-
-  // Vider la pile redo car un nouveau coup a été joué
-  while (!queue_is_empty(g->redo)) {
-    game redo_game = queue_pop_head(g->redo);
-    game_delete(redo_game);
-  }
-
-  // Calculer et appliquer la nouvelle orientation
-  int new_orientation = (g->orientations[index] + nb_quarter_turns) % NB_DIRS;
-  if (new_orientation < 0) {
-    new_orientation += NB_DIRS;  // Corrige les orientations négatives
-  }
-  g->orientations[index] = (direction)new_orientation;
-
-  /*printf("Piece at (%u, %u) rotated. New orientation: %d\n", i, j,
-         g->orientations[index]);*/
+  // Rotation du masque de 4 bits
+  _game_rotate(g, index, turns);
 }
 
 bool game_won(cgame g) {
   if (g == NULL) {
     exit(EXIT_FAILURE);
   }
-  // Vérifier la connectivité
-  if (!game_is_connected(g)) {
-    return false;
-  }
-  // Vérifier les appairages
-  if (!game_is_well_paired(g)) {
+  // Vérifier les appairages : compteur tenu à jour à chaque coup
+  if (g->nb_mismatches != 0) {
     return false;
   }
-  return true;
+  // Vérifier la connectivité, seulement quand tout est bien apparié
+  return game_is_connected(g);
 }
 
 void game_reset_orientation(game g) {
   if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
     exit(EXIT_FAILURE);
   }
 
   // Initialise les orientations à NORTH pour chaque pièce du jeu
   for (uint i = 0; i < g->nb_rows; i++) {
     for (uint j = 0; j < g->nb_cols; j++) {
-      uint index = i * g->nb_cols + j;  // Calculer l'index dans le tableau 1D
-      g->orientations[index] = NORTH;
+      size_t index = _game_index(g, i, j);  // Index dans le tableau 1D
+      g->cells[index] = _cell_encode(_cell_shape(g->cells[index]), NORTH);
     }
   }
+  _game_refresh(g);
+
+  // L'historique n'a plus de sens après la réinitialisation
+  _game_clear_history(g);
 }
 
 void game_shuffle_orientation(game g) {
-  if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
-    exit(EXIT_FAILURE);
-  }
-
-  // Assigne une orientation aléatoire à chauque pièce du jeu
-  for (uint i = 0; i < g->nb_rows; i++) {
-    for (uint j = 0; j < g->nb_cols; j++) {
-      uint index = i * g->nb_cols + j;  // Calculer l'index dans le tableau 1D
-      g->orientations[index] =
-          (direction)(rand() % NB_DIRS);  // Orientation aléatoire
-    }
-  }
+  // Générateur global de la bibliothèque standard
+  game_shuffle_orientation_r(g, NULL);
 }
\ No newline at end of file
@@ -1,22 +1,33 @@
 #include "game_aux.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "game.h"
 #include "game_ext.h"
+#include "game_inline.h"
+#include "game_log.h"
 #include "game_struct.h"
 #include "queue.h"
 
-#define MAX_ROWS 100
-#define MAX_COLS 100
-
-bool visited[MAX_ROWS][MAX_COLS];
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 typedef struct game_s *game;
 
+const edge_status _edge_status[4] = {
+    NOEDGE,    // aucune demi-arête
+    MISMATCH,  // demi-arête seulement chez le voisin
+    MISMATCH,  // demi-arête seulement sur la case
+    MATCH      // deux demi-arêtes qui se font face
+};
+
 int opposite_direction(int d) {
   static const int opposites[] = {SOUTH, WEST, NORTH, EAST};
   return opposites[d];
@@ -24,12 +35,12 @@ int opposite_direction(int d) {
 
 void game_print(cgame g) {
   if (g == NULL) {
-    fprintf(stderr, "Game pointer is NULL\n");
+    GAME_LOG(GAME_LOG_ERROR, "Game pointer is NULL");
     exit(EXIT_FAILURE);
   }
 
-  uint rows = game_nb_rows(g);
-  uint cols = game_nb_cols(g);
+  uint rows = _game_nb_rows(g);
+  uint cols = _game_nb_cols(g);
 
   printf("   ");
   for (uint j = 0; j < cols; j++) {
@@ -44,8 +55,8 @@ void game_print(cgame g) {
   for (uint i = 0; i < rows; i++) {
     printf("%d |", i);
     for (uint j = 0; j < cols; j++) {
-      shape s = game_get_piece_shape(g, i, j);
-      direction d = game_get_piece_orientation(g, i, j);
+      shape s = _game_get_piece_shape(g, i, j);
+      direction d = _game_get_piece_orientation(g, i, j);
 
       if (s == ENDPOINT) {
         if (d == NORTH) {
@@ -144,56 +155,19 @@ game game_default_solution(void) {
 
 bool game_get_ajacent_square(cgame g, uint i, uint j, direction d,
                              uint *pi_next, uint *pj_next) {
-  if (g == NULL || i >= g->nb_rows || j >= g->nb_cols || pi_next == NULL ||
-      pj_next == NULL) {
+  if (g == NULL || i >= g->nb_rows || j >= g->nb_cols || d >= NB_DIRS ||
+      pi_next == NULL || pj_next == NULL) {
     return false;
   }
 
-  if (g->wrapping) {
-    // Cas avec wrapping
-    if (d == NORTH) {
-      *pi_next = (i == 0) ? g->nb_rows - 1 : i - 1;
-      *pj_next = j;
-      return true;
-    } else if (d == SOUTH) {
-      *pi_next = (i == g->nb_rows - 1) ? 0 : i + 1;
-      *pj_next = j;
-      return true;
-    } else if (d == EAST) {
-      *pi_next = i;
-      *pj_next = (j == g->nb_cols - 1) ? 0 : j + 1;
-      return true;
-    } else if (d == WEST) {
-      *pi_next = i;
-      *pj_next = (j == 0) ? g->nb_cols - 1 : j - 1;
-      return true;
-    }
-  } else {
-    // Cas sans wrapping
-    if (d == NORTH) {
-      if (i == 0) return false;  // Bordure en haut
-      *pi_next = i - 1;
-      *pj_next = j;
-      return true;
-    } else if (d == SOUTH) {
-      if (i == g->nb_rows - 1) return false;  // Bordure en bas
-      *pi_next = i + 1;
-      *pj_next = j;
-      return true;
-    } else if (d == EAST) {
-      if (j == g->nb_cols - 1) return false;  // Bordure à droite
-      *pi_next = i;
-      *pj_next = j + 1;
-      return true;
-    } else if (d == WEST) {
-      if (j == 0) return false;  // Bordure à gauche
-      *pi_next = i;
-      *pj_next = j - 1;
-      return true;
-    }
+  // Une seule lecture dans la table des voisins, wrapping ou non
+  size_t next = _game_neighbor(g, _game_index(g, i, j), d);
+  if (next == NO_NEIGHBOR) {
+    return false;  // Bordure de la grille
   }
 
-  return false;  // Si la direction est invalide ou non gérée
+  _game_coords(g, next, pi_next, pj_next);
+  return true;
 }
 
 bool game_has_half_edge(cgame g, uint i, uint j, direction d) {
@@ -201,70 +175,178 @@ bool game_has_half_edge(cgame g, uint i, uint j, direction d) {
       d >= NB_DIRS || i < 0 || j < 0) {
     return false;
   }
-  shape s = game_get_piece_shape(g, i, j);
-  direction dir = game_get_piece_orientation(g, i, j);
 
-  // Toute les possibilités de connection pour chaque direction
-  if (s == CROSS) {
-    return true;
-  }
-  if (s != EMPTY) {
-    if (d == NORTH) {
-      if ((dir == NORTH) || (s == SEGMENT && dir == SOUTH) ||
-          (s == CORNER && dir == WEST) || (s == TEE && dir != SOUTH)) {
-        return true;
-      }
-    } else if (d == SOUTH) {
-      if ((dir == SOUTH) || (s == SEGMENT && dir == NORTH) ||
-          (s == CORNER && dir == EAST) || (s == TEE && dir != NORTH)) {
-        return true;
-      }
-    } else if (d == EAST) {
-      if ((dir == EAST) || (s == SEGMENT && dir == WEST) ||
-          (s == CORNER && dir == NORTH) || (s == TEE && dir != WEST)) {
-        return true;
-      }
-    } else if (d == WEST) {
-      if ((dir == WEST) || (s == SEGMENT && dir == EAST) ||
-          (s == CORNER && dir == SOUTH) || (s == TEE && dir != EAST)) {
-        return true;
-      }
-    }
-  }
-  return false;
+  // Test direct du bit de la demi-arête dans le masque N-E-S-W de la case
+  return _game_has_half_edge(g, _game_index(g, i, j), d);
 }
 
 edge_status game_check_edge(cgame g, uint i, uint j, direction d) {
-  if (g == NULL || i >= g->nb_cols * g->nb_rows ||
-      j >= g->nb_cols * g->nb_rows || d < 0 || d >= NB_DIRS || i < 0 || j < 0) {
+  if (g == NULL || i >= g->nb_rows || j >= g->nb_cols || d < 0 ||
+      d >= NB_DIRS) {
     return NOEDGE;
   }
 
-  uint i_next = 0, j_next = 0;
-  if (!game_get_ajacent_square(g, i, j, d, &i_next, &j_next)) {
-    // Vérifie si une demi-arête est présente sur cette case
-    if (game_has_half_edge(g, i, j, d)) {
-      return MISMATCH;  // Demi-arête seule sans correspondance
-    } else {
-      return NOEDGE;  // Pas de demi-arête
+  // Statut lu dans une table à partir des deux demi-arêtes
+  return _game_check_edge(g, _game_index(g, i, j), d);
+}
+
+/* Nombre de positions k < n où le bit @p bit de x[k] >> 2 diffère de celui de
+ * y[k]. Avec x une ligne et y la même ligne décalée d'une case, on compare
+ * l'est (bit 2) de chaque case à l'ouest (bit 0) de la suivante ; avec x la
+ * ligne du dessous et y une ligne, on compare le nord (bit 3) au sud (bit 1). */
+static uint _count_unpaired(const cell *x, const cell *y, uint n, uint bit) {
+  uint count = 0;
+  uint k = 0;
+#if defined(__AVX2__)
+  const __m256i ones = _mm256_set1_epi8(1);
+  __m256i sum = _mm256_setzero_si256();
+  for (; k + 32 <= n; k += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(x + k));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(y + k));
+    // Décalage par mots de 16 bits : le masque final ne garde que le bit
+    // venant du même octet
+    __m256i t = _mm256_xor_si256(_mm256_srli_epi16(a, 2), b);
+    t = _mm256_and_si256(_mm256_srli_epi16(t, bit), ones);
+    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(t, _mm256_setzero_si256()));
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i *)lanes, sum);
+  count += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__SSE2__)
+  const __m128i ones = _mm_set1_epi8(1);
+  __m128i sum = _mm_setzero_si128();
+  for (; k + 16 <= n; k += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(x + k));
+    __m128i b = _mm_loadu_si128((const __m128i *)(y + k));
+    // Décalage par mots de 16 bits : le masque final ne garde que le bit
+    // venant du même octet
+    __m128i t = _mm_xor_si128(_mm_srli_epi16(a, 2), b);
+    t = _mm_and_si128(_mm_srli_epi16(t, bit), ones);
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(t, _mm_setzero_si128()));
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, sum);
+  count += lanes[0] + lanes[1];
+#else
+  // Repli portable : 8 cases à la fois dans un mot de 64 bits
+  for (; k + 8 <= n; k += 8) {
+    uint64_t a, b;
+    memcpy(&a, x + k, sizeof(a));
+    memcpy(&b, y + k, sizeof(b));
+    uint64_t t = (((a >> 2) ^ b) >> bit) & 0x0101010101010101ULL;
+    count += (t * 0x0101010101010101ULL) >> 56;  // somme des octets
+  }
+#endif
+  for (; k < n; k++) {
+    count += (((x[k] >> 2) ^ y[k]) >> bit) & 1;
+  }
+  return count;
+}
+
+/* Demi-arêtes non appariées d'une grille N x N rangée ligne par ligne : mêmes
+ * comparaisons que _count_unpaired, avec des bornes et des pas constants. */
+#define DEFINE_COUNT_MISMATCHES(N)                                       \
+  static size_t _count_mismatches_##N(const cell *cells, bool wrapping) { \
+    size_t count = 0;                                                    \
+    for (uint k = 0; k < N * N; k++) {                                   \
+      uint i = k / N, j = k % N;                                         \
+      /* Arête est, puis arête sud */                                    \
+      if (j + 1 < N) {                                                   \
+        count += ((cells[k] >> 2) ^ cells[k + 1]) & 1;                   \
+      } else if (wrapping) {                                             \
+        count += ((cells[k] >> 2) ^ cells[k + 1 - N]) & 1;               \
+      } else {                                                           \
+        count += (cells[k] & DIR_BIT(EAST)) != 0;                        \
+      }                                                                  \
+      if (i + 1 < N) {                                                   \
+        count += (((cells[k + N] >> 2) ^ cells[k]) >> 1) & 1;            \
+      } else if (wrapping) {                                             \
+        count += (((cells[j] >> 2) ^ cells[k]) >> 1) & 1;                \
+      } else {                                                           \
+        count += (cells[k] & DIR_BIT(SOUTH)) != 0;                       \
+      }                                                                  \
+      /* Bords ouest et nord, sans voisin */                             \
+      if (!wrapping && j == 0) {                                         \
+        count += (cells[k] & DIR_BIT(WEST)) != 0;                        \
+      }                                                                  \
+      if (!wrapping && i == 0) {                                         \
+        count += (cells[k] & DIR_BIT(NORTH)) != 0;                       \
+      }                                                                  \
+    }                                                                    \
+    return count;                                                        \
+  }
+
+FIXED_SIZES(DEFINE_COUNT_MISMATCHES)
+
+size_t _game_count_mismatches(cgame g) {
+  uint nb_rows = g->nb_rows, nb_cols = g->nb_cols;
+  const cell *cells = g->cells;
+  size_t count = 0;
+  if (nb_rows == 0 || nb_cols == 0) {
+    return 0;
+  }
+
+  // Grilles carrées courantes : noyau spécialisé
+  if (nb_rows == nb_cols && g->tile_cols == 0) {
+#define COUNT_MISMATCHES_CASE(N) \
+  case N:                        \
+    return _count_mismatches_##N(cells, g->wrapping);
+    switch (nb_cols) {
+      FIXED_SIZES(COUNT_MISMATCHES_CASE)
+      default:
+        break;
     }
+#undef COUNT_MISMATCHES_CASE
   }
 
-  // Vérifie si la case voisine (i_next, j_next) a une demi-arête dans la
-  // direction opposée
-  bool edge_s = game_has_half_edge(g, i, j, d);
-  bool edge_aja_s = false;
+  // Disposition en tuiles : les lignes ne sont pas contiguës, chaque case
+  // compte ses arêtes est et sud, et ses demi-arêtes vers le bord
+  if (g->tile_cols != 0) {
+    for (uint i = 0; i < nb_rows; i++) {
+      for (uint j = 0; j < nb_cols; j++) {
+        size_t index = _game_index(g, i, j);
+        for (direction d = 0; d < NB_DIRS; d++) {
+          size_t next = _game_neighbor(g, index, d);
+          if (next == NO_NEIGHBOR) {
+            count += _game_has_half_edge(g, index, d);
+          } else if (d == EAST || d == SOUTH) {
+            count += _game_has_half_edge(g, index, d) !=
+                     _game_has_half_edge(g, next, opposite_direction(d));
+          }
+        }
+      }
+    }
+    return count;
+  }
 
-  edge_aja_s = game_has_half_edge(g, i_next, j_next, opposite_direction(d));
+  // Arêtes horizontales, à l'intérieur de chaque ligne puis sur les bords
+  for (uint i = 0; i < nb_rows; i++) {
+    const cell *row = cells + _game_index(g, i, 0);
+    count += _count_unpaired(row, row + 1, nb_cols - 1, 0);
+    if (g->wrapping) {
+      count += _count_unpaired(row + nb_cols - 1, row, 1, 0);
+    } else {
+      count += (row[0] & DIR_BIT(WEST)) != 0;
+      count += (row[nb_cols - 1] & DIR_BIT(EAST)) != 0;
+    }
+  }
 
-  // Détermine le statut des 2 arêtes
-  if (edge_s && edge_aja_s) {
-    return MATCH;
-  } else if (edge_s || edge_aja_s) {
-    return MISMATCH;
+  // Arêtes verticales, entre chaque ligne et la suivante puis sur les bords
+  for (uint i = 0; i + 1 < nb_rows; i++) {
+    const cell *row = cells + _game_index(g, i, 0);
+    count += _count_unpaired(row + nb_cols, row, nb_cols, 1);
+  }
+  const cell *last = cells + _game_index(g, nb_rows - 1, 0);
+  if (g->wrapping) {
+    count += _count_unpaired(cells, last, nb_cols, 1);
   } else {
-    return NOEDGE;
+    for (uint j = 0; j < nb_cols; j++) {
+      count += (cells[j] & DIR_BIT(NORTH)) != 0;
+      count += (last[j] & DIR_BIT(SOUTH)) != 0;
+    }
   }
+
+  return count;
 }
 
 bool game_is_well_paired(cgame g) {
@@ -272,102 +354,218 @@ bool game_is_well_paired(cgame g) {
     return false;
   }
 
-  for (uint i = 0; i < g->nb_rows; i++) {
-    for (uint j = 0; j < g->nb_cols; j++) {
-      for (direction d = 0; d < NB_DIRS; d++) {
-        if (game_has_half_edge(g, i, j, d)) {
-          // Vérifie l'état de l'arête
-          edge_status status = game_check_edge(g, i, j, d);
+  // Le nombre de demi-arêtes non appariées est tenu à jour à chaque écriture,
+  // et recalculé en bloc par _game_count_mismatches
+  return g->nb_mismatches == 0;
+}
 
-          if (status != MATCH) {
-            return false;  // Une arête mal appariée ou absente
-          }
+// Largeur maximale d'une ligne représentée par un mot de 64 bits
+#define BITBOARD_COLS 64
+
+/* Connexité par remplissage sur des mots de 64 bits, une ligne par mot : le bit
+ * j de east[i] (resp. south[i]) indique une arête bien appariée entre (i, j) et
+ * la case à l'est (resp. au sud). Le remplissage avance d'une ligne entière à
+ * chaque opération, au lieu d'une case. Pour nb_cols <= BITBOARD_COLS, reached
+ * contient au départ la première case non vide. */
+static inline bool _bitboard_flood(uint nb_rows, uint nb_cols, bool wrapping,
+                                   const uint64_t *pieces,
+                                   const uint64_t *east,
+                                   const uint64_t *south, uint64_t *reached) {
+  uint64_t last_col = (uint64_t)1 << (nb_cols - 1);
+
+  // Balayages vers le bas puis vers le haut jusqu'à stabilité
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (uint sweep = 0; sweep < 2 * nb_rows; sweep++) {
+      uint i = (sweep < nb_rows) ? sweep : 2 * nb_rows - 1 - sweep;
+      uint64_t x = reached[i];
+      if (x == 0) continue;
+
+      // Extension horizontale dans la ligne jusqu'à stabilité
+      for (uint64_t prev = 0; prev != x;) {
+        prev = x;
+        x |= ((x & east[i]) << 1) | ((x >> 1) & east[i]);
+        if (wrapping && (east[i] & last_col) && (x & (last_col | 1))) {
+          x |= last_col | 1;
         }
+        x &= pieces[i];
+      }
+      if (x != reached[i]) {
+        reached[i] = x;
+        changed = true;
+      }
+
+      // Propagation verticale vers les lignes voisines
+      uint below = (i + 1 < nb_rows) ? i + 1 : 0;
+      uint above = (i > 0) ? i - 1 : nb_rows - 1;
+      if (i + 1 < nb_rows || wrapping) {
+        uint64_t y = reached[below] | (x & south[i]);
+        changed = changed || y != reached[below];
+        reached[below] = y;
+      }
+      if (i > 0 || wrapping) {
+        uint64_t y = reached[above] | (x & south[above]);
+        changed = changed || y != reached[above];
+        reached[above] = y;
       }
     }
   }
 
-  return true;
-}
-
-// Tableau pour stocker les cases visitées
-bool visited[MAX_COLS][MAX_ROWS];
-
-// Fonction pour effectuer un parcours en profondeur
-void parcours(cgame g, uint i, uint j) {
-  if (g == NULL || i >= g->nb_rows || j >= g->nb_cols) {
-    fprintf(stderr, "Position invalide ou jeu NULL : (%u, %u)\n", i, j);
-    return;
+  // Connecté si toutes les cases non vides ont été atteintes
+  bool connected = true;
+  for (uint i = 0; i < nb_rows && connected; i++) {
+    connected = (reached[i] == pieces[i]);
   }
+  return connected;
+}
 
-  if (visited[i][j]) {
-    return;  // Ne pas revisiter une case
+static bool _is_connected_bitboard(cgame g) {
+  uint nb_rows = g->nb_rows, nb_cols = g->nb_cols;
+  uint64_t *boards = calloc(4 * (size_t)nb_rows, sizeof(uint64_t));
+  if (boards == NULL) {
+    GAME_LOG(GAME_LOG_ERROR,
+             "Failed to allocate memory for connectivity check");
+    exit(EXIT_FAILURE);
   }
+  uint64_t *pieces = boards, *east = boards + nb_rows;
+  uint64_t *south = boards + 2 * nb_rows, *reached = boards + 3 * nb_rows;
 
-  visited[i][j] = true;
-
-  for (int d = 0; d < NB_DIRS; d++) {
-    uint i_next = 0, j_next = 0;
-
-    if (game_get_ajacent_square(g, i, j, d, &i_next, &j_next)) {
-      if (game_check_edge(g, i, j, d) == MATCH) {
-        parcours(g, i_next, j_next);  // Si connecté, visite la case voisine
+  // Construction des mots, avec le point de départ : la première case non vide
+  bool start_found = false;
+  for (uint i = 0; i < nb_rows; i++) {
+    for (uint j = 0; j < nb_cols; j++) {
+      size_t index = _game_index(g, i, j);
+      if (CELL_MASK(g->cells[index]) == 0) continue;
+      uint64_t bit = (uint64_t)1 << j;
+      pieces[i] |= bit;
+      if (!start_found) {
+        reached[i] = bit;
+        start_found = true;
       }
+      if (_game_check_edge(g, index, EAST) == MATCH) east[i] |= bit;
+      if (_game_check_edge(g, index, SOUTH) == MATCH) south[i] |= bit;
     }
   }
+
+  // Aucune demi-arête : le jeu est connecté
+  bool connected = !start_found || _bitboard_flood(nb_rows, nb_cols,
+                                                   g->wrapping, pieces, east,
+                                                   south, reached);
+  free(boards);
+  return connected;
 }
 
+/* Même remplissage pour une grille N x N rangée ligne par ligne : mots sur la
+ * pile, arêtes lues directement dans les cases avec des pas constants. */
+#define DEFINE_IS_CONNECTED(N)                                           \
+  static bool _is_connected_##N(const cell *cells, bool wrapping) {      \
+    uint64_t pieces[N] = {0}, east[N] = {0}, south[N] = {0};             \
+    uint64_t reached[N] = {0};                                           \
+    bool start_found = false;                                            \
+    for (uint k = 0; k < N * N; k++) {                                   \
+      uint i = k / N, j = k % N;                                         \
+      if (CELL_MASK(cells[k]) == 0) continue;                            \
+      uint64_t bit = (uint64_t)1 << j;                                   \
+      pieces[i] |= bit;                                                  \
+      if (!start_found) {                                                \
+        reached[i] = bit;                                                \
+        start_found = true;                                              \
+      }                                                                  \
+      /* Demi-arête est face à la demi-arête ouest du voisin */          \
+      uint k_east = (j + 1 < N) ? k + 1 : k + 1 - N;                     \
+      if ((j + 1 < N || wrapping) &&                                     \
+          (cells[k] & (cells[k_east] << 2) & DIR_BIT(EAST))) {           \
+        east[i] |= bit;                                                  \
+      }                                                                  \
+      /* Demi-arête sud face à la demi-arête nord du voisin */           \
+      uint k_south = (i + 1 < N) ? k + N : j;                            \
+      if ((i + 1 < N || wrapping) &&                                     \
+          (cells[k] & (cells[k_south] >> 2) & DIR_BIT(SOUTH))) {         \
+        south[i] |= bit;                                                 \
+      }                                                                  \
+    }                                                                    \
+    return !start_found ||                                               \
+           _bitboard_flood(N, N, wrapping, pieces, east, south, reached); \
+  }
+
+FIXED_SIZES(DEFINE_IS_CONNECTED)
+
 // Fonction principale pour vérifier si le jeu est connecté
 bool game_is_connected(cgame g) {
   if (g == NULL) {
-    fprintf(stderr, "Le jeu est NULL\n");
+    GAME_LOG(GAME_LOG_ERROR, "Le jeu est NULL");
     return false;
   }
 
-  // Réinitialiser le tableau `visited`
-  for (uint i = 0; i < g->nb_rows; i++) {
-    for (uint j = 0; j < g->nb_cols; j++) {
-      visited[i][j] = false;
+  // Réponse immédiate si le suivi de la connexité est activé
+  if (g->tracker != NULL) {
+    return tracker_nb_components(g->tracker) <= 1;
+  }
+
+  // Grilles carrées courantes : noyau spécialisé
+  if (g->nb_rows == g->nb_cols && g->tile_cols == 0) {
+#define IS_CONNECTED_CASE(N) \
+  case N:                    \
+    return _is_connected_##N(g->cells, g->wrapping);
+    switch (g->nb_cols) {
+      FIXED_SIZES(IS_CONNECTED_CASE)
+      default:
+        break;
     }
+#undef IS_CONNECTED_CASE
   }
 
-  uint start_i = 0, start_j = 0;
+  // Lignes assez courtes : remplissage sur des mots de 64 bits
+  if (g->nb_cols <= BITBOARD_COLS) {
+    return _is_connected_bitboard(g);
+  }
 
-  // Trouver une case valide pour commencer le parcours
-  bool start_found = false;
-  for (uint i = 0; i < g->nb_rows && !start_found; i++) {
-    for (uint j = 0; j < g->nb_cols && !start_found; j++) {
-      for (int d = 0; d < NB_DIRS; d++) {
-        if (game_has_half_edge(g, i, j, d)) {
-          start_i = i;
-          start_j = j;
-          start_found = true;
-          break;
-        }
-      }
+  // Sinon, parcours générique case par case
+  // Compter les cases non vides et trouver un point de départ
+  size_t total_size = _game_size(g);
+  size_t nb_pieces = 0, start = 0;
+  for (size_t index = total_size; index-- > 0;) {
+    if (CELL_MASK(g->cells[index]) != 0) {
+      nb_pieces++;
+      start = index;
     }
   }
-
-  if (!start_found) {
-    printf(
-        "Aucun point de départ trouvé, le jeu est connecté (aucune "
-        "demi-arête).\n");
-    return true;
+  if (nb_pieces == 0) {
+    return true;  // Aucune demi-arête : le jeu est connecté
   }
 
-  // Lancer le parcours depuis le point de départ
-  parcours(g, start_i, start_j);
+  // Parcours itératif avec une pile : les cases visitées sont marquées dans un
+  // ensemble de bits propre à l'appel, chaque case entre au plus une fois dans
+  // la pile, ce qui borne sa taille par le nombre de cases
+  unsigned char *visited = calloc((total_size + 7) / 8, sizeof(unsigned char));
+  size_t *stack = malloc(nb_pieces * sizeof(size_t));
+  if (visited == NULL || stack == NULL) {
+    GAME_LOG(GAME_LOG_ERROR,
+             "Failed to allocate memory for connectivity check");
+    exit(EXIT_FAILURE);
+  }
 
-  // Vérifie si toutes les cases contenant des demi-arêtes ont été visitées
-  for (uint i = 0; i < g->nb_rows; i++) {
-    for (uint j = 0; j < g->nb_cols; j++) {
-      for (int d = 0; d < NB_DIRS; d++) {
-        if (game_has_half_edge(g, i, j, d) && !visited[i][j]) {
-          return false;
-        }
+  size_t nb_visited = 0, top = 0;
+  visited[start / 8] |= 1 << (start % 8);
+  stack[top++] = start;
+  while (top > 0) {
+    size_t index = stack[--top];
+    nb_visited++;
+    uint links = _game_links(g, index);
+    for (direction d = 0; d < NB_DIRS; d++) {
+      if (!(links & DIR_BIT(d))) continue;
+      size_t next = _game_neighbor(g, index, d);
+      if (!(visited[next / 8] & (1 << (next % 8)))) {
+        visited[next / 8] |= 1 << (next % 8);
+        stack[top++] = next;
       }
     }
   }
 
-  return true;
+  free(visited);
+  free(stack);
+
+  // Connecté si toutes les cases contenant des demi-arêtes ont été visitées
+  return nb_visited == nb_pieces;
 }
\ No newline at end of file
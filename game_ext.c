@@ -1,63 +1,190 @@
+#define _DEFAULT_SOURCE  // posix_memalign() et madvise()
+
 #include "game_ext.h"
 
+#include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 #include "game.h"
 #include "game_aux.h"
+#include "game_inline.h"
+#include "game_log.h"
 #include "game_struct.h"
 #include "queue.h"
 
-#define DEFAULT_QUEUE_SIZE 50
-
 typedef struct game_s *game;
 
-game game_new_empty_ext(uint nb_rows, uint nb_cols, bool wrapping) {
-  game g = malloc(sizeof(struct game_s));
-  if (g == NULL) {
-    fprintf(stderr, "Failed to allocate memory for game structure\n");
+// Taille des grandes pages, pour les blocs de grandes grilles
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+size_t game_memory_size(uint nb_rows, uint nb_cols) {
+  // Structure puis cases : un seul bloc, la table des voisins est à part
+  size_t total_size = _layout_size(nb_rows, nb_cols);
+  if (total_size == 0 && nb_rows != 0 && nb_cols != 0) {
+    return 0;  // Dépassement de capacité
+  }
+  if (total_size > SIZE_MAX - sizeof(struct game_s)) {
+    return 0;  // Dépassement de capacité
+  }
+  return sizeof(struct game_s) + total_size * sizeof(cell);
+}
+
+// Table des voisins d'un jeu dont les dimensions sont initialisées, ou NULL
+// au-delà de NEIGHBOR_TABLE_MAX cases : elle coûterait alors 16 fois la
+// mémoire des cases, et les voisins sont calculés à la demande
+static layout *_layout_new(cgame g) {
+  size_t total_size = _game_size(g);
+  if (total_size > NEIGHBOR_TABLE_MAX) {
+    return NULL;
+  }
+
+  layout *l = malloc(sizeof(layout) + total_size * NB_DIRS * sizeof(uint));
+  if (l == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to allocate memory for neighbors");
     exit(EXIT_FAILURE);
   }
+  l->refcount = 1;
 
-  // Initialisation dimensions
+  // Calculée une fois pour toutes, les cases de remplissage des tuiles n'ont
+  // pas de voisins
+  if (g->tile_cols != 0) {
+    memset(l->neighbors, 0xFF, total_size * NB_DIRS * sizeof(uint));
+  }
+  for (uint i = 0; i < g->nb_rows; i++) {
+    for (uint j = 0; j < g->nb_cols; j++) {
+      size_t index = _game_index(g, i, j);
+      for (direction d = 0; d < NB_DIRS; d++) {
+        size_t next = _game_neighbor_slow(g, index, d);
+        l->neighbors[index * NB_DIRS + d] =
+            (next == NO_NEIGHBOR) ? NO_TABLE_NEIGHBOR : (uint)next;
+      }
+    }
+  }
+  return l;
+}
+
+void _layout_release(layout *l) {
+  if (l != NULL && _ref_release(&l->refcount)) {
+    free(l);
+  }
+}
+
+// Initialise un jeu vide dans son bloc, en partageant la table des voisins
+// shared si elle est fournie
+static void _game_init(game g, uint nb_rows, uint nb_cols, bool wrapping,
+                       layout *shared) {
+  // Initialisation dimensions et disposition des cases
   g->nb_rows = nb_rows;
   g->nb_cols = nb_cols;
+  g->wrapping = wrapping;
+  g->owned = false;
+  g->tile_cols = _layout_tiled(nb_cols) ? (nb_cols + TILE_MASK) / TILE_SIZE : 0;
+
+  // Initialisation des cases, qui suivent la structure dans le même bloc :
+  // EMPTY orientée NORTH est codée par 0
+  g->cells = (cell *)(g + 1);
+  memset(g->cells, 0, _game_size(g) * sizeof(cell));
+
+  // Table des voisins : partagée entre un jeu et ses copies
+  if (shared != NULL) {
+    _ref_acquire(&shared->refcount);
+    g->layout = shared;
+  } else {
+    g->layout = _layout_new(g);
+  }
+  g->neighbors = (g->layout != NULL) ? g->layout->neighbors : NULL;
+
+  // Les piles undo et redo ne sont créées qu'au premier coup joué
+  g->undo = NULL;
+  g->redo = NULL;
+
+  g->nb_mismatches = 0;  // Grille vide : aucune demi-arête
+  g->hash = 0;           // Empreinte d'une grille vide
+  g->generation = 0;
+  g->tracker = NULL;     // Suivi de la connexité désactivé par défaut
+  g->history_max = 0;    // Historique non borné par défaut
+  g->base = NULL;        // Aucun instantané
+  g->dirty = NULL;
+}
 
-  uint total_size = nb_rows * nb_cols;
+// Alloue le bloc d'un jeu. Les grands blocs sont alignés sur les grandes
+// pages, pour limiter les défauts de TLB lors des parcours complets
+static game _game_alloc(uint nb_rows, uint nb_cols) {
+  size_t size = game_memory_size(nb_rows, nb_cols);
+  if (size == 0) {
+    GAME_LOG(GAME_LOG_ERROR, "Game too large: %u x %u", nb_rows, nb_cols);
+    exit(EXIT_FAILURE);
+  }
 
-  // Initialisation et remplissage des tableaux shapes et orientations
-  g->shapes = malloc(total_size * sizeof(shape));
-  g->orientations = malloc(total_size * sizeof(direction));
-  if (g->shapes == NULL || g->orientations == NULL) {
-    fprintf(stderr, "Failed to allocate memory for shapes or orientations\n");
-    free(g);
+  void *block = NULL;
+  if (size >= HUGE_PAGE_SIZE) {
+#if defined(__linux__)
+    if (posix_memalign(&block, HUGE_PAGE_SIZE, size) == 0) {
+      madvise(block, size, MADV_HUGEPAGE);
+    } else {
+      block = NULL;
+    }
+#else
+    block = malloc(size);
+#endif
+  } else {
+    block = malloc(size);
+  }
+  if (block == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to allocate memory for game structure");
     exit(EXIT_FAILURE);
   }
+  return block;
+}
 
-  for (uint i = 0; i < total_size; i++) {
-    g->shapes[i] = EMPTY;
-    g->orientations[i] = NORTH;
+game game_new_empty_at(void *buffer, uint nb_rows, uint nb_cols,
+                       bool wrapping) {
+  if (buffer == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null buffer pointer");
+    exit(EXIT_FAILURE);
   }
 
-  // Initailisation piles undo et redo
-  g->undo = queue_new();
-  g->redo = queue_new();
-  if (g->undo == NULL || g->redo == NULL) {
-    fprintf(stderr, "Failed to initialize undo or redo stacks\n");
-    free(g->shapes);
-    free(g->orientations);
-    queue_free_full(g->undo, NULL);
-    queue_free_full(g->redo, NULL);
-    free(g);
+  game g = buffer;
+  _game_init(g, nb_rows, nb_cols, wrapping, NULL);
+  return g;
+}
+
+game game_new_empty_like_at(void *buffer, cgame model) {
+  if (buffer == NULL || model == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null pointer");
     exit(EXIT_FAILURE);
   }
 
-  g->wrapping = wrapping;
+  // Table des voisins de model : ni allocation ni calcul
+  game g = buffer;
+  _game_init(g, model->nb_rows, model->nb_cols, model->wrapping,
+             model->layout);
+  return g;
+}
+
+game game_new_empty_ext(uint nb_rows, uint nb_cols, bool wrapping) {
+  // Une seule allocation pour la structure et ses cases
+  game g = _game_alloc(nb_rows, nb_cols);
+  _game_init(g, nb_rows, nb_cols, wrapping, NULL);
+  g->owned = true;
   return g;
 }
 
+game _game_new_shared(cgame g) {
+  game new_game = _game_alloc(g->nb_rows, g->nb_cols);
+  _game_init(new_game, g->nb_rows, g->nb_cols, g->wrapping, g->layout);
+  new_game->owned = true;
+  return new_game;
+}
+
 game game_new_ext(uint nb_rows, uint nb_cols, shape *shapes,
                   direction *orientations, bool wrapping) {
   game g = game_new_empty_ext(nb_rows, nb_cols, wrapping);
@@ -65,104 +192,641 @@ game game_new_ext(uint nb_rows, uint nb_cols, shape *shapes,
     return NULL;
   }
 
-  if (shapes != NULL) {
-    for (uint i = 0; i < nb_rows * nb_cols; i++) {
-      g->shapes[i] = shapes[i];
+  if (shapes != NULL || orientations != NULL) {
+    size_t k = 0;  // Index dans les tableaux, ligne par ligne
+    for (uint i = 0; i < nb_rows; i++) {
+      for (uint j = 0; j < nb_cols; j++, k++) {
+        shape s = (shapes != NULL) ? shapes[k] : EMPTY;
+        direction o = (orientations != NULL) ? orientations[k] : NORTH;
+        g->cells[_game_index(g, i, j)] = _cell_encode(s, o);
+      }
     }
+    _game_refresh(g);
   }
 
-  if (orientations != NULL) {
-    for (uint i = 0; i < nb_rows * nb_cols; i++) {
-      g->orientations[i] = orientations[i];
+  return g;
+}
+
+void game_copy_into(game dst, cgame src) {
+  if (dst == NULL || src == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  if (dst->nb_rows != src->nb_rows || dst->nb_cols != src->nb_cols ||
+      dst->wrapping != src->wrapping) {
+    GAME_LOG(GAME_LOG_ERROR, "Games with different dimensions or wrapping");
+    exit(EXIT_FAILURE);
+  }
+
+  if (dst == src) {
+    return;
+  }
+
+  // Les voisins sont identiques : seules les cases sont copiées, en un bloc
+  memcpy(dst->cells, src->cells, _game_size(src) * sizeof(cell));
+  dst->nb_mismatches = src->nb_mismatches;
+  dst->hash = src->hash;
+  dst->generation++;
+  if (dst->tracker != NULL) {
+    tracker_rebuild(dst->tracker, dst);
+  }
+  if (dst->dirty != NULL) {
+    memset(dst->dirty, true, _game_nb_chunks(dst) * sizeof(bool));
+  }
+
+  // Comme pour une copie neuve, l'historique de dst est vidé
+  _game_clear_history(dst);
+}
+
+void game_save_orientations(cgame g, direction *orientations) {
+  if (g == NULL || orientations == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  size_t k = 0;  // Index dans le tableau, ligne par ligne
+  for (uint i = 0; i < g->nb_rows; i++) {
+    for (uint j = 0; j < g->nb_cols; j++, k++) {
+      orientations[k] = CELL_ORIENTATION(g->cells[_game_index(g, i, j)]);
+    }
+  }
+}
+
+void _game_write_orientations(game g, const direction *orientations) {
+  // Écriture directe des cases, puis un seul recalcul des appariements
+  size_t k = 0;  // Index dans le tableau, ligne par ligne
+  for (uint i = 0; i < g->nb_rows; i++) {
+    for (uint j = 0; j < g->nb_cols; j++, k++) {
+      size_t index = _game_index(g, i, j);
+      g->cells[index] =
+          _cell_encode(_cell_shape(g->cells[index]), orientations[k]);
     }
   }
+  _game_refresh(g);
+}
 
+void game_restore_orientations(game g, const direction *orientations) {
+  if (g == NULL || orientations == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  record *r = _game_write_begin(g, 0, true);
+  _game_write_orientations(g, orientations);
+  _game_write_end(g, r);
+}
+
+static void _chunk_release(chunk *c) {
+  if (_ref_release(&c->refcount)) {
+    free(c);
+  }
+}
+
+void _snapshot_release(snapshot s) {
+  if (s == NULL || !_ref_release(&s->refcount)) {
+    return;
+  }
+  for (size_t k = 0; k < s->nb_chunks; k++) {
+    _chunk_release(s->chunks[k]);
+  }
+  _layout_release(s->layout);
+  free(s);
+}
+
+// Fait de s l'instantané de référence de g, dont les cases sont identiques à
+// celles de s : aucun morceau n'est alors modifié
+static void _game_set_base(game g, snapshot s) {
+  size_t nb_chunks = _game_nb_chunks(g);
+  _ref_acquire(&s->refcount);
+  _snapshot_release(g->base);
+  g->base = s;
+  if (g->dirty == NULL) {
+    g->dirty = malloc(nb_chunks * sizeof(bool));
+    if (g->dirty == NULL) {
+      GAME_LOG(GAME_LOG_ERROR, "Failed to allocate memory for snapshot");
+      exit(EXIT_FAILURE);
+    }
+  }
+  memset(g->dirty, false, nb_chunks * sizeof(bool));
+}
+
+snapshot game_snapshot(game g) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  size_t nb_chunks = _game_nb_chunks(g);
+  snapshot s = malloc(sizeof(struct snapshot_s) + nb_chunks * sizeof(chunk *));
+  if (s == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to allocate memory for snapshot");
+    exit(EXIT_FAILURE);
+  }
+  s->refcount = 1;
+  s->nb_rows = g->nb_rows;
+  s->nb_cols = g->nb_cols;
+  s->wrapping = g->wrapping;
+  s->layout = g->layout;
+  if (s->layout != NULL) {
+    _ref_acquire(&s->layout->refcount);
+  }
+  s->nb_mismatches = g->nb_mismatches;
+  s->hash = g->hash;
+  s->nb_chunks = nb_chunks;
+
+  // Les morceaux non modifiés depuis l'instantané précédent sont partagés
+  // avec lui, les autres sont recopiés
+  size_t total_size = _game_size(g);
+  for (size_t k = 0; k < nb_chunks; k++) {
+    if (g->base != NULL && !g->dirty[k]) {
+      s->chunks[k] = g->base->chunks[k];
+      _ref_acquire(&s->chunks[k]->refcount);
+      continue;
+    }
+    chunk *c = malloc(sizeof(chunk) + CHUNK_SIZE * sizeof(cell));
+    if (c == NULL) {
+      GAME_LOG(GAME_LOG_ERROR, "Failed to allocate memory for snapshot");
+      exit(EXIT_FAILURE);
+    }
+    c->refcount = 1;
+    size_t start = k * CHUNK_SIZE;
+    size_t size = (total_size - start < CHUNK_SIZE) ? total_size - start
+                                                     : CHUNK_SIZE;
+    memcpy(c->cells, g->cells + start, size * sizeof(cell));
+    s->chunks[k] = c;
+  }
+
+  _game_set_base(g, s);
+  return s;
+}
+
+void game_restore_snapshot(game g, snapshot s) {
+  if (g == NULL || s == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  if (g->nb_rows != s->nb_rows || g->nb_cols != s->nb_cols ||
+      g->wrapping != s->wrapping) {
+    GAME_LOG(GAME_LOG_ERROR, "Snapshot of a game with different dimensions");
+    exit(EXIT_FAILURE);
+  }
+
+  record *r = _game_write_begin(g, 0, true);
+
+  // Seuls les morceaux qui diffèrent de s sont recopiés : ceux modifiés depuis
+  // l'instantané de référence, ou qu'il ne partage pas avec s
+  size_t total_size = _game_size(g);
+  for (size_t k = 0; k < s->nb_chunks; k++) {
+    if (g->base != NULL && !g->dirty[k] && g->base->chunks[k] == s->chunks[k]) {
+      continue;
+    }
+    size_t start = k * CHUNK_SIZE;
+    size_t size = (total_size - start < CHUNK_SIZE) ? total_size - start
+                                                     : CHUNK_SIZE;
+    memcpy(g->cells + start, s->chunks[k]->cells, size * sizeof(cell));
+  }
+  g->nb_mismatches = s->nb_mismatches;
+  g->hash = s->hash;
+  g->generation++;
+  if (g->tracker != NULL) {
+    tracker_rebuild(g->tracker, g);
+  }
+
+  _game_write_end(g, r);
+  _game_set_base(g, s);
+}
+
+game game_fork(snapshot s) {
+  if (s == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null snapshot pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  // Comme game_copy : la table des voisins est partagée
+  game g = _game_alloc(s->nb_rows, s->nb_cols);
+  _game_init(g, s->nb_rows, s->nb_cols, s->wrapping, s->layout);
+  g->owned = true;
+  game_restore_snapshot(g, s);
   return g;
 }
 
+void snapshot_delete(snapshot s) {
+  if (s == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null snapshot pointer");
+    exit(EXIT_FAILURE);
+  }
+  _snapshot_release(s);
+}
+
+void game_shuffle_orientation_r(game g, uint64_t *rng) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  record *r = _game_write_begin(g, 0, true);
+
+  // Assigne une orientation aléatoire à chaque pièce du jeu
+  for (uint i = 0; i < g->nb_rows; i++) {
+    for (uint j = 0; j < g->nb_cols; j++) {
+      size_t index = _game_index(g, i, j);  // Index dans le tableau 1D
+      g->cells[index] =
+          _cell_encode(_cell_shape(g->cells[index]),
+                       (direction)_rng_below(rng, NB_DIRS));
+    }
+  }
+  _game_refresh(g);
+  _game_write_end(g, r);
+}
+
 uint game_nb_rows(cgame g) {
   if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
     exit(EXIT_FAILURE);
   }
 
-  return g->nb_rows;
+  return _game_nb_rows(g);
 }
 
 uint game_nb_cols(cgame g) {
   if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
     exit(EXIT_FAILURE);
   }
-  return g->nb_cols;
+  return _game_nb_cols(g);
 }
 
 bool game_is_wrapping(cgame g) {
   if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
     exit(EXIT_FAILURE);
   }
-  return g->wrapping;
+  return _game_is_wrapping(g);
 }
 
-void game_undo(game g) {
+uint game_get_piece_mask(cgame g, uint i, uint j) {
+  assert(g != NULL);
+  assert(i < g->nb_rows);
+  assert(j < g->nb_cols);
+  return CELL_MASK(g->cells[_game_index(g, i, j)]);
+}
+
+void game_set_piece_mask(game g, uint i, uint j, uint mask) {
+  assert(g != NULL);
+  assert(i < g->nb_rows);
+  assert(j < g->nb_cols);
+  assert(mask < 16);
+  // Forme et orientation lues dans la table inverse des masques
+  size_t index = _game_index(g, i, j);
+  record *r = _game_write_begin(g, index, false);
+  _game_set_cell(g, index, _cell_from_mask(mask));
+  _game_write_end(g, r);
+}
+
+void game_add_half_edge(game g, uint i, uint j, direction d) {
+  assert(g != NULL);
+  assert(i < g->nb_rows);
+  assert(j < g->nb_cols);
+  assert(d < NB_DIRS);
+  size_t index = _game_index(g, i, j);
+  uint mask = CELL_MASK(g->cells[index]);
+  assert((mask & DIR_BIT(d)) == 0);
+  record *r = _game_write_begin(g, index, false);
+  _game_set_cell(g, index, _cell_from_mask(mask | DIR_BIT(d)));
+  _game_write_end(g, r);
+}
+
+// Signale la case index de b, différente dans a, et renvoie 1
+static size_t _diff_cell(cgame b, size_t index, game_diff_callback callback,
+                         void *user_data) {
+  if (callback != NULL) {
+    uint i, j;
+    _game_coords(b, index, &i, &j);
+    cell c = b->cells[index];
+    callback(i, j, _cell_shape(c), CELL_ORIENTATION(c), user_data);
+  }
+  return 1;
+}
+
+size_t game_diff(cgame a, cgame b, game_diff_callback callback,
+                 void *user_data) {
+  if (a == NULL || b == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  if (a->nb_rows != b->nb_rows || a->nb_cols != b->nb_cols) {
+    GAME_LOG(GAME_LOG_ERROR, "Games with different dimensions");
+    exit(EXIT_FAILURE);
+  }
+
+  // Comparaison par mots de 8 cases : seuls les mots différents sont détaillés,
+  // octet par octet. Les cases de remplissage des tuiles sont vides des deux
+  // côtés
+  size_t total_size = _game_size(a), count = 0, k = 0;
+  for (; k + sizeof(uint64_t) <= total_size; k += sizeof(uint64_t)) {
+    uint64_t x, y;
+    memcpy(&x, a->cells + k, sizeof(x));
+    memcpy(&y, b->cells + k, sizeof(y));
+    if (x == y) continue;
+    for (size_t l = 0; l < sizeof(uint64_t); l++) {
+      if (a->cells[k + l] != b->cells[k + l]) {
+        count += _diff_cell(b, k + l, callback, user_data);
+      }
+    }
+  }
+  for (; k < total_size; k++) {
+    if (a->cells[k] != b->cells[k]) {
+      count += _diff_cell(b, k, callback, user_data);
+    }
+  }
+  return count;
+}
+
+game_view game_cells_view(cgame g) {
   if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
     exit(EXIT_FAILURE);
   }
 
-  // Vérifier si la pile d'annulation est vide
-  if (queue_is_empty(g->undo)) {
-    printf("No move to undo.\n");
+  // Pas de pas entre les lignes quand les cases sont rangées par tuiles
+  game_view view = {.cells = g->cells,
+                    .nb_rows = g->nb_rows,
+                    .nb_cols = g->nb_cols,
+                    .stride = (g->tile_cols == 0) ? g->nb_cols : 0,
+                    .generation = g->generation};
+  return view;
+}
+
+shape game_view_shape(unsigned char c) {
+  // Même table que pour les cases du jeu
+  return _mask_shape[GAME_VIEW_MASK(c)];
+}
+
+uint64_t game_generation(cgame g) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+  return g->generation;
+}
+
+uint64_t game_hash(cgame g) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+  return g->hash;
+}
+
+void game_track_connectivity(game g, bool enable) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  if (enable && _game_size(g) >= UINT_MAX) {
+    // Le suivi indexe les cases sur 32 bits
+    GAME_LOG(GAME_LOG_ERROR, "Game too large for connectivity tracking");
     return;
   }
 
-  // Sauvegarder l'état actuel dans la pile redo
-  queue_push_head(g->redo, game_copy(g));
+  if (enable && g->tracker == NULL) {
+    g->tracker = tracker_new(g);
+  } else if (!enable && g->tracker != NULL) {
+    tracker_free(g->tracker);
+    g->tracker = NULL;
+  }
+}
 
-  // Restaurer l'état précédent depuis la pile undo
-  game previous_game = queue_pop_head(g->undo);
+// Nombre de composantes par parcours itératif avec une pile, pour les grilles
+// trop grandes pour le suivi, dont les cases sont indexées sur 32 bits
+static uint _count_components(cgame g) {
+  size_t total_size = _game_size(g);
+  size_t nb_pieces = 0;
+  for (size_t index = 0; index < total_size; index++) {
+    nb_pieces += (CELL_MASK(g->cells[index]) != 0);
+  }
+  if (nb_pieces == 0) {
+    return 0;
+  }
 
-  // Copier les données de l'état précédent dans le jeu actuel
-  uint total_size = g->nb_rows * g->nb_cols;
-  for (uint i = 0; i < total_size; i++) {
-    g->shapes[i] = previous_game->shapes[i];
-    g->orientations[i] = previous_game->orientations[i];
+  // Chaque case entre au plus une fois dans la pile
+  unsigned char *visited = calloc((total_size + 7) / 8, sizeof(unsigned char));
+  size_t *stack = malloc(nb_pieces * sizeof(size_t));
+  if (visited == NULL || stack == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to allocate memory for components count");
+    exit(EXIT_FAILURE);
   }
 
-  // Libérer l'état précédent après sa restauration
-  game_delete(previous_game);
+  size_t nb = 0;
+  for (size_t start = 0; start < total_size; start++) {
+    if (CELL_MASK(g->cells[start]) == 0 ||
+        (visited[start / 8] & (1 << (start % 8)))) {
+      continue;
+    }
+    nb++;  // Nouvelle composante
+    size_t top = 0;
+    visited[start / 8] |= 1 << (start % 8);
+    stack[top++] = start;
+    while (top > 0) {
+      size_t index = stack[--top];
+      uint links = _game_links(g, index);
+      for (direction d = 0; d < NB_DIRS; d++) {
+        if (!(links & DIR_BIT(d))) continue;
+        size_t next = _game_neighbor(g, index, d);
+        if (!(visited[next / 8] & (1 << (next % 8)))) {
+          visited[next / 8] |= 1 << (next % 8);
+          stack[top++] = next;
+        }
+      }
+    }
+  }
 
-  printf("Move undone successfully.\n");
+  free(visited);
+  free(stack);
+  return (nb > UINT_MAX) ? UINT_MAX : (uint)nb;
 }
 
-void game_redo(game g) {
+uint game_nb_components(cgame g) {
   if (g == NULL) {
-    fprintf(stderr, "Null game pointer\n");
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
     exit(EXIT_FAILURE);
   }
 
-  // Vérifier si la pile redo est vide
-  if (queue_is_empty(g->redo)) {
-    printf("No move to redo.\n");
+  // Réponse immédiate si le suivi est activé
+  if (g->tracker != NULL) {
+    return tracker_nb_components(g->tracker);
+  }
+
+  // Grille trop grande pour le suivi : parcours sans lui
+  if (_game_size(g) >= UINT_MAX) {
+    return _count_components(g);
+  }
+
+  // Sinon, calcul complet avec un suivi temporaire
+  tracker *t = tracker_new(g);
+  uint nb = tracker_nb_components(t);
+  tracker_free(t);
+  return nb;
+}
+
+void game_set_history_limit(game g, uint max_moves, size_t max_bytes) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  // La limite en octets est convertie en nombre de coups
+  uint limit = max_moves;
+  if (max_bytes > 0) {
+    size_t by_bytes = max_bytes / RECORD_SIZE;
+    if (by_bytes == 0) {
+      by_bytes = 1;  // Au moins le dernier coup reste annulable
+    }
+    if (limit == 0 || by_bytes < limit) {
+      limit = (by_bytes > (uint)-1) ? (uint)-1 : (uint)by_bytes;
+    }
+  }
+  g->history_max = limit;
+
+  // Appliquer tout de suite la nouvelle limite, les coups annulés d'abord
+  if (g->undo == NULL) {
+    return;  // Aucun coup joué
+  }
+  while (limit > 0 &&
+         (uint)(queue_length(g->undo) + queue_length(g->redo)) > limit) {
+    if (!queue_is_empty(g->redo)) {
+      // Le dernier coup du groupe le plus lointain, puis les coups liés
+      free(queue_pop_tail(g->redo));
+      while (!queue_is_empty(g->redo) &&
+             ((record *)queue_peek_tail(g->redo))->linked) {
+        free(queue_pop_tail(g->redo));
+      }
+    } else {
+      // Le premier coup du groupe le plus ancien, jusqu'à son dernier coup
+      record *old = queue_pop_tail(g->undo);
+      while (old->linked && !queue_is_empty(g->undo)) {
+        free(old);
+        old = queue_pop_tail(g->undo);
+      }
+      free(old);
+    }
+  }
+}
+
+size_t game_history_size(cgame g) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  if (g->undo == NULL) {
+    return 0;  // Aucun coup joué
+  }
+  return (size_t)(queue_length(g->undo) + queue_length(g->redo)) * RECORD_SIZE;
+}
+
+void game_play_moves(game g, const move *moves, size_t nb_moves, bool grouped,
+                     bool *won) {
+  if (g == NULL || (moves == NULL && nb_moves > 0)) {
+    GAME_LOG(GAME_LOG_ERROR, "Null pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  // Tous les coups sont vérifiés avant d'en jouer un seul
+  for (size_t k = 0; k < nb_moves; k++) {
+    if (moves[k].i >= g->nb_rows || moves[k].j >= g->nb_cols) {
+      GAME_LOG(GAME_LOG_ERROR, "Out-of-bounds index");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  size_t nb_pushed = 0;
+  for (size_t k = 0; k < nb_moves; k++) {
+    size_t index = _game_index(g, moves[k].i, moves[k].j);
+    if (CELL_MASK(g->cells[index]) == 0) {
+      continue;  // Pièce EMPTY : aucun changement
+    }
+    uint turns = moves[k].nb_quarter_turns & 0x03;
+    _game_push_record(g, index, turns, grouped);
+    _game_rotate(g, index, turns);
+    nb_pushed++;
+  }
+
+  // Le dernier coup du groupe termine l'entrée de l'historique, qui n'est
+  // bornée qu'ensuite pour ne jamais couper le groupe
+  if (grouped && nb_pushed > 0) {
+    ((record *)queue_peek_head(g->undo))->linked = false;
+    _game_trim_history(g, nb_pushed);
+  }
+
+  if (won != NULL) {
+    *won = game_won(g);
+  }
+}
+
+// Annule (undo) ou rejoue un enregistrement de l'historique
+static void _record_apply(game g, const record *r, bool undo) {
+  if (r->kind == RECORD_MOVE) {
+    _game_rotate(g, r->index, undo ? (NB_DIRS - r->turns) & 0x03 : r->turns);
+  } else if (r->kind == RECORD_SQUARE) {
+    _game_set_cell(g, r->index, r->cells[undo ? 0 : 1]);
+  } else {
+    // Toutes les cases : copie en bloc, puis un seul recalcul
+    size_t size = _game_size(g);
+    memcpy(g->cells, r->cells + (undo ? 0 : size), size * sizeof(cell));
+    _game_refresh(g);
+  }
+}
+
+void game_undo(game g) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  // Vérifier si la pile d'annulation est vide
+  if (g->undo == NULL || queue_is_empty(g->undo)) {
+    GAME_LOG(GAME_LOG_INFO, "No move to undo.");
     return;
   }
 
-  // Sauvegarder l'état actuel dans la pile undo
-  queue_push_head(g->undo, game_copy(g));
+  // Annuler le coup par la rotation inverse et le garder pour redo, ainsi que
+  // les coups joués avec lui dans un même groupe et les écritures qui l'ont
+  // suivi
+  do {
+    record *r = queue_pop_head(g->undo);
+    _record_apply(g, r, true);
+    queue_push_head(g->redo, r);
+  } while (!queue_is_empty(g->undo) &&
+           ((record *)queue_peek_head(g->undo))->linked);
+
+  GAME_LOG(GAME_LOG_DEBUG, "Move undone successfully.");
+}
 
-  // Restaurer l'état suivant depuis la pile redo
-  game next_game = queue_pop_head(g->redo);
+void game_redo(game g) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
 
-  // Copier les données de l'état suivant dans le jeu actuel
-  uint total_size = g->nb_rows * g->nb_cols;
-  for (uint i = 0; i < total_size; i++) {
-    g->shapes[i] = next_game->shapes[i];
-    g->orientations[i] = next_game->orientations[i];
+  // Vérifier si la pile redo est vide
+  if (g->redo == NULL || queue_is_empty(g->redo)) {
+    GAME_LOG(GAME_LOG_INFO, "No move to redo.");
+    return;
   }
 
-  // Libérer l'état suivant après sa restauration
-  game_delete(next_game);
+  // Rejouer le coup et le remettre dans l'historique, jusqu'à la fin de son
+  // groupe
+  record *r;
+  do {
+    r = queue_pop_head(g->redo);
+    _record_apply(g, r, false);
+    queue_push_head(g->undo, r);
+  } while (r->linked && !queue_is_empty(g->redo));
 
-  printf("Move redone successfully.\n");
+  GAME_LOG(GAME_LOG_DEBUG, "Move redone successfully.");
 }
\ No newline at end of file
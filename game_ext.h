@@ -9,6 +9,8 @@
 #define __GAME_EXT_H__
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "game.h"
 
@@ -48,6 +50,150 @@ game game_new_ext(uint nb_rows, uint nb_cols, shape *shapes,
  **/
 game game_new_empty_ext(uint nb_rows, uint nb_cols, bool wrapping);
 
+/**
+ * @brief Gets the size of the memory block holding a game.
+ * @details A game and all its squares are stored in a single block of this
+ * size. The neighbor table, shared by a game and its copies, is allocated
+ * separately, as is the undo/redo history on the first move.
+ * @param nb_rows number of rows in game
+ * @param nb_cols number of columns in game
+ * @return the size of the block in bytes, or 0 if it does not fit in a size_t
+ **/
+size_t game_memory_size(uint nb_rows, uint nb_cols);
+
+/**
+ * @brief Creates a new empty game in a memory block provided by the caller.
+ * @details Same as @ref game_new_empty_ext, but the structure and the
+ * squares are placed in @p buffer instead of being allocated. The buffer does
+ * not hold the whole game: the neighbor table is still allocated and computed
+ * by each call, which costs one allocation per game and up to 16 times the
+ * memory of the squares. To carve many games of the same dimensions out of a
+ * single arena, see @ref game_new_empty_like_at. The game must still be
+ * deleted with @ref game_delete, which frees its history and its neighbor
+ * table but not @p buffer. The buffer may then be reused for another game.
+ * @param buffer the memory block
+ * @param nb_rows number of rows in game
+ * @param nb_cols number of columns in game
+ * @param wrapping wrapping option
+ * @pre @p buffer is suitably aligned for any type (as returned by malloc) and
+ * has a size of at least game_memory_size(nb_rows, nb_cols) bytes
+ * @return the created game, located at @p buffer
+ **/
+game game_new_empty_at(void *buffer, uint nb_rows, uint nb_cols,
+                       bool wrapping);
+
+/**
+ * @brief Creates a new empty game in a memory block provided by the caller,
+ * with the dimensions of another game.
+ * @details Same as @ref game_new_empty_at, with the dimensions and the
+ * wrapping option of @p model, whose neighbor table is shared instead of being
+ * allocated and computed again: no memory is allocated until the first move.
+ * @p model may be deleted before the created game.
+ * @param buffer the memory block
+ * @param model the game giving the dimensions and the neighbor table
+ * @pre @p buffer is suitably aligned for any type (as returned by malloc) and
+ * has a size of at least game_memory_size(nb_rows, nb_cols) bytes, for the
+ * dimensions of @p model
+ * @return the created game, located at @p buffer
+ **/
+game game_new_empty_like_at(void *buffer, cgame model);
+
+/**
+ * @brief Copies a game into another existing game.
+ * @details Same as @ref game_copy, without any allocation: all the squares of
+ * @p src are copied into @p dst, whose history is cleared. The settings of @p
+ * dst (connectivity tracking, history limit) are kept.
+ * @param dst the game to overwrite
+ * @param src the game to copy
+ * @pre @p dst and @p src are valid pointers toward game structures with the
+ * same dimensions and wrapping option
+ **/
+void game_copy_into(game dst, cgame src);
+
+/**
+ * @brief Saves the orientation of all the pieces of a game.
+ * @param g the game
+ * @param orientations an array of size nb_rows*nb_cols, filled with the
+ * orientation of the piece in each square (row-major storage convention)
+ * @pre @p g is a valid pointer toward a cgame structure
+ **/
+void game_save_orientations(cgame g, direction *orientations);
+
+/**
+ * @brief Restores the orientation of all the pieces of a game.
+ * @details The orientations are typically saved by @ref
+ * game_save_orientations. This is not a move: it is undone together with the
+ * last move, see @ref game_undo.
+ * @param g the game
+ * @param orientations an array of size nb_rows*nb_cols describing the
+ * orientation of the piece in each square (row-major storage convention)
+ * @pre @p g is a valid pointer toward a game structure
+ **/
+void game_restore_orientations(game g, const direction *orientations);
+
+/**
+ * @brief The structure pointer that stores an immutable state of a game.
+ * @details The squares are stored in reference-counted chunks of a few rows,
+ * shared between successive snapshots: a snapshot only copies the chunks
+ * written since the previous snapshot of the same game.
+ **/
+typedef struct snapshot_s *snapshot;
+
+/**
+ * @brief Takes a snapshot of a game.
+ * @details The snapshot shares with the previous snapshot taken from (or
+ * restored into) @p g all the chunks that have not been written since, so
+ * that its cost is a pointer per chunk plus the chunks touched in between.
+ * The settings and the history of the game are not part of the snapshot.
+ * @param g the game
+ * @pre @p g is a valid pointer toward a game structure
+ * @return the snapshot, to be freed with @ref snapshot_delete
+ **/
+snapshot game_snapshot(game g);
+
+/**
+ * @brief Restores a snapshot into a game.
+ * @details Only the chunks that differ between @p g and @p s are copied. This
+ * is not a move: it is undone together with the last move, see @ref
+ * game_undo.
+ * @param g the game
+ * @param s the snapshot
+ * @pre @p g and @p s are valid pointers, @p s was taken from a game with the
+ * same dimensions and wrapping option
+ **/
+void game_restore_snapshot(game g, snapshot s);
+
+/**
+ * @brief Creates a new game from a snapshot.
+ * @details Same as @ref game_copy of the game the snapshot was taken from, at
+ * that time. The new game shares its neighbor table with it, and the next
+ * snapshot of the new game only copies the chunks written in between.
+ * @param s the snapshot
+ * @pre @p s is a valid pointer toward a snapshot
+ * @return the created game
+ **/
+game game_fork(snapshot s);
+
+/**
+ * @brief Deletes a snapshot.
+ * @details The chunks still used by other snapshots are kept.
+ * @param s the snapshot
+ * @pre @p s is a valid pointer toward a snapshot
+ **/
+void snapshot_delete(snapshot s);
+
+/**
+ * @brief Shuffles the orientation of all the pieces, with a given generator.
+ * @details Same as @ref game_shuffle_orientation, but the random numbers are
+ * drawn from the generator whose state is @p rng, so that several threads can
+ * shuffle games concurrently and reproducibly.
+ * @param g the game
+ * @param rng the state of the generator, initialized with any seed and updated
+ * by the call, or NULL to use rand() as @ref game_shuffle_orientation
+ * @pre @p g is a valid pointer toward a game structure
+ **/
+void game_shuffle_orientation_r(game g, uint64_t *rng);
+
 /**
  * @brief Gets the number of rows (or height).
  * @param g the game
@@ -71,12 +217,237 @@ uint game_nb_cols(cgame g);
  **/
 bool game_is_wrapping(cgame g);
 
+/**
+ * @brief Gets the half-edge mask of the piece in a given square.
+ * @details The mask has one bit per half-edge of the piece, as oriented on the
+ * grid: 0b1000 for NORTH, 0b0100 for EAST, 0b0010 for SOUTH and 0b0001 for
+ * WEST. For instance, 0b1100 is a corner in north orientation.
+ * @param g the game
+ * @param i row index
+ * @param j column index
+ * @pre @p g is a valid pointer toward a cgame structure
+ * @pre @p i < game height
+ * @pre @p j < game width
+ * @return the half-edge mask of the piece, in 0..15
+ **/
+uint game_get_piece_mask(cgame g, uint i, uint j);
+
+/**
+ * @brief Sets the piece in a given square from its half-edge mask.
+ * @details The shape and the orientation are those of the piece having this
+ * mask. Symmetrical pieces get the first orientation giving the mask: NORTH
+ * for a vertical SEGMENT or a CROSS, EAST for a horizontal SEGMENT.
+ * @param g the game
+ * @param i row index
+ * @param j column index
+ * @param mask the half-edge mask, see @ref game_get_piece_mask
+ * @pre @p g is a valid pointer toward a game structure
+ * @pre @p i < game height
+ * @pre @p j < game width
+ * @pre @p mask < 16
+ **/
+void game_set_piece_mask(game g, uint i, uint j, uint mask);
+
+/**
+ * @brief Adds a half-edge to the piece in a given square.
+ * @details Only this square is modified: the half-edge of the adjacent square
+ * is left unchanged. The new piece is set as by @ref game_set_piece_mask.
+ * @param g the game
+ * @param i row index
+ * @param j column index
+ * @param d the direction of the half-edge
+ * @pre @p g is a valid pointer toward a game structure
+ * @pre @p i < game height
+ * @pre @p j < game width
+ * @pre the piece has no half-edge in the direction @p d
+ **/
+void game_add_half_edge(game g, uint i, uint j, direction d);
+
+/**
+ * @brief Function receiving the squares that differ, see @ref game_diff.
+ * @param i row index of the square
+ * @param j column index of the square
+ * @param s the shape of the piece in the second game
+ * @param o the orientation of the piece in the second game
+ * @param user_data the pointer given to @ref game_diff
+ **/
+typedef void (*game_diff_callback)(uint i, uint j, shape s, direction o,
+                                   void *user_data);
+
+/**
+ * @brief Compares two games square by square.
+ * @details The squares are compared 8 at a time, so that the cost is mostly
+ * proportional to the number of differences for similar games. A square
+ * differs if its shape or its orientation differs (as in @ref game_equal, not
+ * ignoring the orientation). The squares are reported in storage order, which
+ * is row by row except for very wide grids.
+ * @param a the first game
+ * @param b the second game, whose pieces are given to @p callback
+ * @param callback function called once per square that differs, or NULL to
+ * count them only
+ * @param user_data pointer given back to @p callback
+ * @pre @p a and @p b are valid pointers toward game structures with the same
+ * dimensions
+ * @return the number of squares that differ
+ **/
+size_t game_diff(cgame a, cgame b, game_diff_callback callback,
+                 void *user_data);
+
+/**
+ * @brief Half-edge mask of a packed square of a @ref game_view: one bit per
+ * direction, from 0b1000 for NORTH to 0b0001 for WEST.
+ **/
+#define GAME_VIEW_MASK(c) ((c)&0x0F)
+
+/**
+ * @brief Orientation of the piece of a packed square of a @ref game_view.
+ **/
+#define GAME_VIEW_ORIENTATION(c) ((direction)(((c) >> 4) & 0x03))
+
+/**
+ * @brief Shape of the piece of a packed square of a @ref game_view.
+ * @details The shape is the one having the half-edge mask of the square when
+ * oriented as given by @ref GAME_VIEW_ORIENTATION.
+ * @param c the packed square
+ * @return the shape of the piece
+ **/
+shape game_view_shape(unsigned char c);
+
+/**
+ * @brief Read-only view of the squares of a game, see @ref game_cells_view.
+ * @details Each square is packed in a byte, decoded by @ref game_view_shape,
+ * @ref GAME_VIEW_ORIENTATION and @ref GAME_VIEW_MASK.
+ **/
+typedef struct {
+  const unsigned char *cells;  // square (i, j) at cells[i * stride + j]
+  uint nb_rows, nb_cols;
+  size_t stride;  // squares between two rows, 0 if they are not row-major
+  uint64_t generation;  // see game_generation()
+} game_view;
+
+/**
+ * @brief Gets a read-only view of the internal squares of a game.
+ * @details No copy is made: the view remains valid until the game is deleted,
+ * and follows its changes. The squares are stored row-major, except for very
+ * wide grids (stride 0), which must be read with the accessors.
+ * @param g the game
+ * @pre @p g is a valid pointer toward a cgame structure
+ * @return the view
+ **/
+game_view game_cells_view(cgame g);
+
+/**
+ * @brief Gets the generation of a game.
+ * @details The generation is incremented on every change of the squares, so
+ * that a renderer can skip a redraw when it is the same as last time.
+ * @param g the game
+ * @pre @p g is a valid pointer toward a cgame structure
+ * @return the number of changes of the squares since the game was created
+ **/
+uint64_t game_generation(cgame g);
+
+/**
+ * @brief Gets a 64-bit hash of the state of the game.
+ * @details The hash depends on the shape and the orientation of every piece,
+ * and is updated in constant time by each modification of the game. Two equal
+ * games (see @ref game_equal, with orientation) have the same hash; games
+ * with different dimensions may share a hash.
+ * @param g the game
+ * @return the hash of the game
+ * @pre @p g is a valid pointer toward a cgame structure
+ **/
+uint64_t game_hash(cgame g);
+
+/**
+ * @brief Enables or disables the incremental connectivity tracking.
+ * @details When enabled, the connected components of the network are kept up
+ * to date by every modification of the game, so that @ref game_nb_components
+ * and @ref game_is_connected answer without walking the whole grid. This costs
+ * a few integers per square. The tracking is not copied by @ref game_copy,
+ * and is not available for games of 2^32 squares or more.
+ * @param g the game
+ * @param enable true to enable the tracking, false to disable it
+ * @pre @p g is a valid pointer toward a game structure
+ **/
+void game_track_connectivity(game g, bool enable);
+
+/**
+ * @brief Gets the number of connected components of the network.
+ * @details Two non-empty squares belong to the same component if there is a
+ * path of well-matched edges between them. This is O(1) when the connectivity
+ * tracking is enabled, otherwise the whole grid is walked, also for the grids
+ * too large for the tracking (see @ref game_track_connectivity).
+ * @param g the game
+ * @return the number of connected components (0 for an empty game)
+ * @pre @p g is a valid pointer toward a cgame structure
+ **/
+uint game_nb_components(cgame g);
+
+/**
+ * @brief Bounds the undo/redo history.
+ * @details Once the limit is reached, playing a new move forgets the oldest
+ * one. A limit of 0 means no limit on that criterion; when both are given the
+ * strictest one applies. If the history is already larger than the new limit,
+ * it is shrunk immediately. The limit counts the moves recorded, not the
+ * undo steps: a group of moves played by @ref game_play_moves counts as its
+ * number of moves, and is forgotten as a whole. The last group played stays
+ * undoable even if it alone exceeds the limit. A write that is not a move
+ * (see @ref game_undo) counts as one more move of the last entry.
+ * @param g the game
+ * @param max_moves maximum number of moves kept in the history
+ * @param max_bytes maximum memory used by the history, in bytes
+ * @pre @p g is a valid pointer toward a game structure
+ **/
+void game_set_history_limit(game g, uint max_moves, size_t max_bytes);
+
+/**
+ * @brief Gets the memory currently used by the undo/redo history.
+ * @details Each recorded move or write counts for the same size: the copies
+ * of the squares kept by the writes of the whole grid are not included.
+ * @param g the game
+ * @return the size of the history in bytes
+ * @pre @p g is a valid pointer toward a cgame structure
+ **/
+size_t game_history_size(cgame g);
+
+/**
+ * @brief A move: quarter turns applied to the piece of a square.
+ **/
+typedef struct {
+  uint i;                /**< row of the square */
+  uint j;                /**< column of the square */
+  int nb_quarter_turns;  /**< number of clockwise quarter turns (may be
+                            negative) */
+} move;
+
+/**
+ * @brief Plays a sequence of moves.
+ * @details Same as calling @ref game_play_move for each move, except that all
+ * the moves are checked before any of them is played. Moves on empty squares
+ * are skipped silently.
+ * @param g the game
+ * @param moves the array of moves
+ * @param nb_moves the number of moves
+ * @param grouped if true, the whole sequence is a single history entry,
+ * undone and redone at once; otherwise each move is an entry of its own
+ * @param won if not NULL, set to the result of @ref game_won after the last
+ * move
+ * @pre @p g is a valid pointer toward a game structure
+ * @pre all the moves are inside the grid
+ **/
+void game_play_moves(game g, const move *moves, size_t nb_moves, bool grouped,
+                     bool *won);
+
 /**
  * @brief Undoes the last move.
  * @details Searches in the history the last move played (by calling
  * @ref game_play_move or @ref game_redo), and restores the state of the game
  * before that move. If no moves have been played, this function does nothing.
- * The @ref game_reset_orientation function clears the history.
+ * The writes made since that move without playing a move (setters, @ref
+ * game_shuffle_orientation, @ref game_solve, @ref game_restore_orientations,
+ * @ref game_restore_snapshot) are undone with it, and redone with it by @ref
+ * game_redo. @ref game_reset_orientation and @ref game_copy_into clear the
+ * history.
  * @param g the game
  * @pre @p g is a valid pointer toward a cgame structure
  **/
@@ -0,0 +1,55 @@
+/**
+ * @file game_inline.h
+ * @brief Unchecked inline accessors.
+ * @details Same as the accessors of game.h and game_ext.h, without any check
+ * of the arguments, so that they are inlined in the loops over the squares.
+ * Reserved to the library and to trusted callers: the checked functions remain
+ * the public API.
+ * @copyright University of Bordeaux. All rights reserved, 2024.
+ **/
+
+#ifndef __GAME_INLINE_H__
+#define __GAME_INLINE_H__
+
+#include <stdbool.h>
+
+#include "game.h"
+#include "game_struct.h"
+
+/**
+ * @brief Gets the number of rows, see game_nb_rows().
+ * @pre @p g is a valid pointer toward a cgame structure
+ */
+static inline uint _game_nb_rows(cgame g) { return g->nb_rows; }
+
+/**
+ * @brief Gets the number of columns, see game_nb_cols().
+ * @pre @p g is a valid pointer toward a cgame structure
+ */
+static inline uint _game_nb_cols(cgame g) { return g->nb_cols; }
+
+/**
+ * @brief Checks the wrapping option, see game_is_wrapping().
+ * @pre @p g is a valid pointer toward a cgame structure
+ */
+static inline bool _game_is_wrapping(cgame g) { return g->wrapping; }
+
+/**
+ * @brief Gets the shape of a piece, see game_get_piece_shape().
+ * @pre @p g is a valid pointer toward a cgame structure
+ * @pre @p i < game height, @p j < game width
+ */
+static inline shape _game_get_piece_shape(cgame g, uint i, uint j) {
+  return _cell_shape(g->cells[_game_index(g, i, j)]);
+}
+
+/**
+ * @brief Gets the orientation of a piece, see game_get_piece_orientation().
+ * @pre @p g is a valid pointer toward a cgame structure
+ * @pre @p i < game height, @p j < game width
+ */
+static inline direction _game_get_piece_orientation(cgame g, uint i, uint j) {
+  return CELL_ORIENTATION(g->cells[_game_index(g, i, j)]);
+}
+
+#endif  // __GAME_INLINE_H__
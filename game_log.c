@@ -0,0 +1,43 @@
+#include "game_log.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+// Taille maximale d'un message, tronqué au-delà
+#define LOG_MESSAGE_SIZE 256
+
+// Sortie par défaut : la sortie d'erreur standard
+static void _log_stderr(game_log_level level, const char *message,
+                        void *user_data) {
+  (void)level;
+  (void)user_data;
+  fprintf(stderr, "%s\n", message);
+}
+
+// Réglages de la bibliothèque, fixés avant l'utilisation par plusieurs fils
+static game_log_callback _callback = _log_stderr;
+static void *_user_data = NULL;
+static game_log_level _level = GAME_LOG_WARNING;
+
+void game_log_set_callback(game_log_callback callback, void *user_data) {
+  _callback = callback;
+  _user_data = user_data;
+}
+
+void game_log_set_level(game_log_level level) { _level = level; }
+
+game_log_level game_log_get_level(void) { return _level; }
+
+void _game_log(game_log_level level, const char *format, ...) {
+  // Message ignoré avant même d'être mis en forme
+  if (level < _level || _callback == NULL) {
+    return;
+  }
+
+  char message[LOG_MESSAGE_SIZE];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  _callback(level, message, _user_data);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file game_log.h
+ * @brief Logging of the library.
+ * @details All the messages of the library (errors, warnings, information on
+ * the moves) go through this module instead of being printed directly. By
+ * default, warnings and errors are written on the standard error output. An
+ * application may install its own callback, or raise the level to silence the
+ * library. Defining GAME_LOG_MIN_LEVEL at compile time removes the messages
+ * below that level from the library entirely, including their arguments.
+ * @copyright University of Bordeaux. All rights reserved, 2024.
+ **/
+
+#ifndef __GAME_LOG_H__
+#define __GAME_LOG_H__
+
+/**
+ * @brief Levels of the messages, by increasing severity.
+ */
+typedef enum {
+  GAME_LOG_DEBUG = 0, /**< details of the normal operation */
+  GAME_LOG_INFO,      /**< notable events, such as a move undone */
+  GAME_LOG_WARNING,   /**< request ignored, such as a move on an empty square */
+  GAME_LOG_ERROR,     /**< invalid argument or failure, often fatal */
+  GAME_LOG_NONE       /**< above all levels: no message */
+} game_log_level;
+
+/**
+ * @brief Function receiving the messages of the library.
+ * @param level the level of the message
+ * @param message the message, without final newline
+ * @param user_data the pointer given to @ref game_log_set_callback
+ */
+typedef void (*game_log_callback)(game_log_level level, const char *message,
+                                  void *user_data);
+
+/**
+ * @brief Sets the function receiving the messages of the library.
+ * @details Like @ref game_log_set_level, to be called before the library is
+ * used by several threads: the callback itself may then be called from any of
+ * them.
+ * @param callback the function, or NULL to discard all the messages
+ * @param user_data pointer given back to @p callback with each message
+ */
+void game_log_set_callback(game_log_callback callback, void *user_data);
+
+/**
+ * @brief Sets the minimum level of the messages sent to the callback.
+ * @param level the minimum level, GAME_LOG_WARNING by default
+ */
+void game_log_set_level(game_log_level level);
+
+/**
+ * @brief Gets the minimum level of the messages sent to the callback.
+ * @return the minimum level
+ */
+game_log_level game_log_get_level(void);
+
+/** messages below this level are removed at compile time */
+#ifndef GAME_LOG_MIN_LEVEL
+#define GAME_LOG_MIN_LEVEL GAME_LOG_DEBUG
+#endif
+
+/** send a printf-like message of a given level, see game_log.c */
+void _game_log(game_log_level level, const char *format, ...);
+
+/** log a message from the library, unless its level is compiled out */
+#define GAME_LOG(level, ...)               \
+  do {                                     \
+    if ((level) >= GAME_LOG_MIN_LEVEL) {   \
+      _game_log((level), __VA_ARGS__);     \
+    }                                      \
+  } while (0)
+
+#endif  // __GAME_LOG_H__
@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,18 +7,389 @@
 #include "game.h"
 #include "game_aux.h"
 #include "queue.h"
+#include "tracker.h"
 
 #ifndef __GAME_STRUCT_H__
 #define __GAME_STRUCT_H__
 
+/* ************************************************************************** */
+
+/**
+ * @brief Packed representation of a square.
+ * @details The 4 least significant bits hold the N-E-S-W half-edge mask (same
+ * coding as @ref _code in add_edge.c), bits 4-5 hold the orientation. The shape
+ * is recovered from the mask, the orientation is kept so that symmetrical
+ * pieces (SEGMENT, CROSS, EMPTY) remember how they were placed.
+ */
+typedef unsigned char cell;
+
+#define CELL_MASK(c) ((c)&0x0F)
+#define CELL_ORIENTATION(c) ((direction)(((c) >> 4) & 0x03))
+#define CELL_MAKE(mask, o) ((cell)(((mask)&0x0F) | (((o)&0x03) << 4)))
+
+/** bit of the half-edge in the direction d */
+#define DIR_BIT(d) (0b1000 >> (d))
+
+/** hard-coding of pieces, see add_edge.c */
+extern const uint _code[NB_SHAPES][NB_DIRS];
+
+/** shape of the piece having a given half-edge mask, see add_edge.c */
+extern const shape _mask_shape[16];
+
+/** orientation of the piece having a given half-edge mask (the first one in
+ * @ref _code for symmetrical pieces), see add_edge.c */
+extern const direction _mask_orientation[16];
+
+/** status of an edge indexed by (half-edge here << 1) | half-edge there, see
+ * game_aux.c */
+extern const edge_status _edge_status[4];
+
+/** index of the square beyond the border of a non-wrapping grid */
+#define NO_NEIGHBOR ((size_t)-1)
+
+/** same sentinel, as stored in the neighbor table */
+#define NO_TABLE_NEIGHBOR ((uint)-1)
+
+/** grids with more squares than this have no neighbor table (16 bytes per
+ * square), the neighbors are then computed from the coordinates */
+#define NEIGHBOR_TABLE_MAX ((size_t)1 << 24)
+
+/** sizes N of the square N x N grids having specialized kernels, as an
+ * X-macro: X(N) is expanded once per size, see game_aux.c and game_tools.c */
+#define FIXED_SIZES(X) X(4) X(5) X(7) X(9)
+
+/* ************************************************************************** */
+
+/**
+ * @brief Entry of the undo/redo history.
+ * @details A move is stored as the rotation it applied, so that undoing it is
+ * the opposite rotation and redoing it is the same rotation again. The moves
+ * of a group (see game_play_moves()) are linked records ended by an unlinked
+ * one, so that they form a single history entry. A write that is not a move
+ * (setters, shuffle, solver...) is stored as the values of the squares before
+ * and after it, and linked to the last entry, which is then undone with it.
+ */
+typedef struct {
+  size_t index;  // index of the rotated or written square
+  uint turns;    // clockwise quarter turns, in 0..3, for a move
+  bool linked;   // undone and redone together with the next record played
+  uint8_t kind;  // RECORD_MOVE, RECORD_SQUARE or RECORD_GRID
+  cell cells[];  // for a write, the old values of the squares, then the new
+} record;
+
+/** kinds of records: a move, a write of one square, a write of all squares */
+#define RECORD_MOVE 0
+#define RECORD_SQUARE 1
+#define RECORD_GRID 2
+
+/** memory used by one history entry, including its queue element (3 pointers,
+ * see queue.c) */
+#define RECORD_SIZE (sizeof(record) + 3 * sizeof(void *))
+
+/**
+ * @brief Neighbor table of a grid.
+ * @details Immutable once built, and shared by a game and all its copies: only
+ * the squares are duplicated by game_copy(). Freed with the last game using
+ * it, see _layout_release().
+ */
+typedef struct {
+  uint refcount;     // number of games using the table
+  uint neighbors[];  // index of the adjacent square, NB_DIRS per square
+} layout;
+
+/** number of squares in a chunk of a snapshot, that is a few rows of a large
+ * grid (or a few rows of tiles, see _game_index()) */
+#define CHUNK_SIZE 4096
+
+/**
+ * @brief Chunk of the squares of a snapshot.
+ * @details Immutable once built, and shared by all the snapshots in which this
+ * part of the grid is the same, see game_snapshot().
+ */
+typedef struct {
+  uint refcount;  // number of snapshots using the chunk
+  cell cells[];   // CHUNK_SIZE squares, stored as in the game
+} chunk;
+
+/**
+ * @brief Immutable state of a game, see game_ext.h.
+ */
+struct snapshot_s {
+  uint refcount;  // number of users: the caller, and games based on it
+  uint nb_rows, nb_cols;
+  bool wrapping;
+  layout *layout;        // neighbor table of the game, shared with it
+  size_t nb_mismatches;  // counters of the game when the snapshot was taken
+  uint64_t hash;
+  size_t nb_chunks;
+  chunk *chunks[];  // squares, CHUNK_SIZE per chunk
+};
+
+/* ************************************************************************** */
+
 struct game_s {
   uint nb_rows, nb_cols;
   bool wrapping;
-  shape *shapes;
-  direction *orientations;
+  bool owned;       // true if the block was allocated by the library
+  uint tile_cols;   // number of tiles per row of tiles, 0 for row-major
+  cell *cells;      // stored in the same block as the structure, see
+                    // _game_index() for the layout
+  layout *layout;   // shared neighbor table, NULL for grids larger than
+                    // NEIGHBOR_TABLE_MAX
+  uint *neighbors;  // layout->neighbors, or NULL
+  size_t nb_mismatches;  // number of half-edges not paired with a neighbor
+  uint64_t hash;         // Zobrist hash of the squares, see _zobrist()
+  uint64_t generation;   // incremented on every write of the squares
+  tracker *tracker;    // connectivity tracker, NULL unless enabled
 
-  queue *undo;
+  queue *undo;  // history of records, most recent at the head, created lazily
   queue *redo;
+  uint history_max;  // maximum number of records kept, 0 for no limit
+
+  struct snapshot_s *base;  // last snapshot taken from or restored into the
+                            // game, NULL if none
+  bool *dirty;  // chunks written since base, NULL if there is no base
 };
 
-#endif  // __GAME_STRUCT_H__
\ No newline at end of file
+/* ************************************************************************** */
+
+/** add a reference to an object that may be shared between threads (neighbor
+ * tables, snapshots and their chunks) */
+static inline void _ref_acquire(uint *refcount) {
+#if defined(__GNUC__)
+  __atomic_add_fetch(refcount, 1, __ATOMIC_RELAXED);
+#else
+  (*refcount)++;
+#endif
+}
+
+/** release a reference, returns true if it was the last one */
+static inline bool _ref_release(uint *refcount) {
+#if defined(__GNUC__)
+  return __atomic_sub_fetch(refcount, 1, __ATOMIC_ACQ_REL) == 0;
+#else
+  return --(*refcount) == 0;
+#endif
+}
+
+/** next value of the splitmix64 generator of state @p *rng */
+static inline uint64_t _rng_next(uint64_t *rng) {
+  uint64_t z = (*rng += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+/** random integer in 0..n-1, drawn from @p rng, or from rand() if @p rng is
+ * NULL */
+static inline uint _rng_below(uint64_t *rng, uint n) {
+  return (rng != NULL) ? (uint)(_rng_next(rng) % n) : (uint)(rand() % n);
+}
+
+/* ************************************************************************** */
+
+static inline cell _cell_encode(shape s, direction o) {
+  return CELL_MAKE(_code[s][o], o);
+}
+
+static inline cell _cell_from_mask(uint mask) {
+  return CELL_MAKE(mask, _mask_orientation[mask & 0x0F]);
+}
+
+static inline shape _cell_shape(cell c) { return _mask_shape[CELL_MASK(c)]; }
+
+/** Zobrist key of the value @p c at square @p index. The keys are derived
+ * with the splitmix64 finalizer instead of being stored in a table, so that
+ * they cost no memory even for huge grids. An empty square facing north has
+ * key 0: the hash of an empty grid is 0. */
+static inline uint64_t _zobrist(size_t index, cell c) {
+  if (c == 0) return 0;
+  uint64_t z = ((uint64_t)index << 6 | c) + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+/** rotate a half-edge mask clockwise by k quarter turns */
+static inline uint _rotate_mask(uint mask, uint k) {
+  k &= 0x03;
+  return ((mask >> k) | (mask << (NB_DIRS - k))) & 0x0F;
+}
+
+/** rotate a packed square clockwise by k quarter turns */
+static inline cell _cell_rotate(cell c, uint k) {
+  return CELL_MAKE(_rotate_mask(CELL_MASK(c), k), CELL_ORIENTATION(c) + k);
+}
+
+/* Layout of the squares. Narrow grids are stored in row-major order. Grids of
+ * at least TILED_MIN_COLS columns are stored as TILE_SIZE x TILE_SIZE tiles,
+ * each tile in row-major order and the tiles themselves in row-major order,
+ * so that the squares above and below are usually in the same few cache lines
+ * instead of a full row away. The grid is then padded with empty squares up to
+ * a multiple of TILE_SIZE in both dimensions; these squares are nobody's
+ * neighbor. */
+
+#define TILE_SHIFT 4
+#define TILE_SIZE (1u << TILE_SHIFT)
+#define TILE_MASK (TILE_SIZE - 1)
+
+#ifndef TILED_MIN_COLS
+#define TILED_MIN_COLS 1024
+#endif
+
+/** true if a grid with @p nb_cols columns is stored as tiles */
+static inline bool _layout_tiled(uint nb_cols) {
+  return nb_cols >= TILED_MIN_COLS;
+}
+
+/** number of squares stored for a grid, padding included, or 0 on overflow */
+static inline size_t _layout_size(uint nb_rows, uint nb_cols) {
+  size_t rows = nb_rows, cols = nb_cols;
+  if (_layout_tiled(nb_cols)) {
+    rows = (rows + TILE_MASK) & ~(size_t)TILE_MASK;
+    cols = (cols + TILE_MASK) & ~(size_t)TILE_MASK;
+  }
+  if (rows != 0 && rows * cols / rows != cols) return 0;
+  return rows * cols;
+}
+
+/** number of squares stored for a game, i.e. size of the cell array */
+static inline size_t _game_size(cgame g) {
+  return _layout_size(g->nb_rows, g->nb_cols);
+}
+
+/** number of snapshot chunks covering the squares stored for @p g */
+static inline size_t _game_nb_chunks(cgame g) {
+  return (_game_size(g) + CHUNK_SIZE - 1) / CHUNK_SIZE;
+}
+
+/** index of the square at row @p i and column @p j */
+static inline size_t _game_index(cgame g, uint i, uint j) {
+  if (g->tile_cols == 0) return (size_t)i * g->nb_cols + j;
+  size_t tile = (size_t)(i >> TILE_SHIFT) * g->tile_cols + (j >> TILE_SHIFT);
+  return (tile << (2 * TILE_SHIFT)) | ((i & TILE_MASK) << TILE_SHIFT) |
+         (j & TILE_MASK);
+}
+
+/** row and column of the square at @p index, inverse of _game_index() */
+static inline void _game_coords(cgame g, size_t index, uint *pi, uint *pj) {
+  if (g->tile_cols == 0) {
+    *pi = index / g->nb_cols;
+    *pj = index % g->nb_cols;
+    return;
+  }
+  size_t tile = index >> (2 * TILE_SHIFT);
+  uint row_in_tile = (index >> TILE_SHIFT) & TILE_MASK;
+  *pi = (uint)(tile / g->tile_cols) << TILE_SHIFT | row_in_tile;
+  *pj = (uint)(tile % g->tile_cols) << TILE_SHIFT | (index & TILE_MASK);
+}
+
+/** neighbor computed from the coordinates, for grids without a table */
+static inline size_t _game_neighbor_slow(cgame g, size_t index,
+                                         direction d) {
+  uint i, j;
+  _game_coords(g, index, &i, &j);
+  uint rows = g->nb_rows, cols = g->nb_cols;
+  switch (d) {
+    case NORTH:
+      if (i > 0) return _game_index(g, i - 1, j);
+      return g->wrapping ? _game_index(g, rows - 1, j) : NO_NEIGHBOR;
+    case SOUTH:
+      if (i + 1 < rows) return _game_index(g, i + 1, j);
+      return g->wrapping ? _game_index(g, 0, j) : NO_NEIGHBOR;
+    case WEST:
+      if (j > 0) return _game_index(g, i, j - 1);
+      return g->wrapping ? _game_index(g, i, cols - 1) : NO_NEIGHBOR;
+    default:  // EAST
+      if (j + 1 < cols) return _game_index(g, i, j + 1);
+      return g->wrapping ? _game_index(g, i, 0) : NO_NEIGHBOR;
+  }
+}
+
+/** index of the square adjacent to @p index in the direction @p d, or
+ * NO_NEIGHBOR if the square is on the border of a non-wrapping grid */
+static inline size_t _game_neighbor(cgame g, size_t index, direction d) {
+  if (g->neighbors == NULL) return _game_neighbor_slow(g, index, d);
+  uint next = g->neighbors[index * NB_DIRS + d];
+  return (next == NO_TABLE_NEIGHBOR) ? NO_NEIGHBOR : next;
+}
+
+/* ************************************************************************** */
+
+/* Unchecked variants of game_has_half_edge() and game_check_edge(), for the
+ * solver and the connectivity walk. The square is given by its index and the
+ * caller is responsible for the bounds. */
+
+static inline bool _game_has_half_edge(cgame g, size_t index, direction d) {
+  return (g->cells[index] & DIR_BIT(d)) != 0;
+}
+
+static inline edge_status _game_check_edge(cgame g, size_t index,
+                                           direction d) {
+  uint here = (g->cells[index] >> (NB_DIRS - 1 - d)) & 1;
+  size_t next = _game_neighbor(g, index, d);
+  uint there = (next == NO_NEIGHBOR)
+                   ? 0
+                   : (g->cells[next] >> (NB_DIRS - 1 - ((d + 2) & 0x03))) & 1;
+  return _edge_status[(here << 1) | there];
+}
+
+/** directions of the well-matched edges of a square, one DIR_BIT each */
+static inline uint _game_links(cgame g, size_t index) {
+  uint links = 0;
+  for (direction d = 0; d < NB_DIRS; d++) {
+    if (_game_check_edge(g, index, d) == MATCH) links |= DIR_BIT(d);
+  }
+  return links;
+}
+
+/* ************************************************************************** */
+
+/** count the half-edges without a matching half-edge, with a vectorized scan of
+ * the rows, see game_aux.c */
+size_t _game_count_mismatches(cgame g);
+
+/** write a square and keep the incremental counters up to date, see game.c */
+void _game_set_cell(game g, size_t index, cell c);
+
+/** allocate an empty game sharing the neighbor table of @p g, see
+ * game_ext.c */
+game _game_new_shared(cgame g);
+
+/** release a reference to a neighbor table, see game_ext.c */
+void _layout_release(layout *l);
+
+/** release a reference to a snapshot, see game_ext.c */
+void _snapshot_release(struct snapshot_s *s);
+
+/** push a move in the history, see game.c */
+void _game_push_record(game g, size_t index, uint turns, bool linked);
+
+/** forget the oldest groups of moves beyond the history limit, keeping the
+ * last @p keep records, see game.c */
+void _game_trim_history(game g, size_t keep);
+
+/** start recording a write that is not a move, of the square @p index or of
+ * all the squares if @p whole, see game.c */
+record *_game_write_begin(game g, size_t index, bool whole);
+
+/** end recording a write started by _game_write_begin(), see game.c */
+void _game_write_end(game g, record *r);
+
+/** forget the undo/redo history when the whole game is replaced, see game.c */
+void _game_clear_history(game g);
+
+/** rotate a square clockwise by @p turns quarter turns, without history */
+static inline void _game_rotate(game g, size_t index, uint turns) {
+  _game_set_cell(g, index, _cell_rotate(g->cells[index], turns));
+}
+
+/** recompute the incremental counters from scratch after a bulk write of the
+ * squares, see game.c */
+void _game_refresh(game g);
+
+/** write the orientation of every square, row by row, without touching the
+ * history, see game_ext.c */
+void _game_write_orientations(game g, const direction *orientations);
+
+#endif  // __GAME_STRUCT_H__
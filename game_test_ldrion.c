@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,6 +7,7 @@
 #include "game.h"
 #include "game_aux.h"
 #include "game_ext.h"
+#include "game_log.h"
 #include "game_struct.h"
 #include "game_tools.h"
 #include "queue.h"
@@ -408,6 +410,252 @@ bool test_game_is_connected(void) {
          test_g_wrapping;
 }
 
+bool test_game_is_connected_large(void) {
+  // Grille de plus de 100x100 cases, entièrement faite de croix
+  uint n = 150;
+  shape *shapes = malloc(n * n * sizeof(shape));
+  assert(shapes != NULL);
+  for (uint k = 0; k < n * n; k++) shapes[k] = CROSS;
+  game g = game_new_ext(n, n, shapes, NULL, true);
+  bool ok = game_is_connected(g) && game_won(g);
+  game_delete(g);
+  free(shapes);
+
+  // Très long chemin sur une seule ligne, qui ferait déborder la pile d'un
+  // parcours récursif
+  uint len = 200000;
+  shapes = malloc(len * sizeof(shape));
+  direction *orientations = malloc(len * sizeof(direction));
+  assert(shapes != NULL && orientations != NULL);
+  for (uint k = 0; k < len; k++) {
+    shapes[k] = SEGMENT;
+    orientations[k] = EAST;
+  }
+  shapes[0] = shapes[len - 1] = ENDPOINT;
+  orientations[len - 1] = WEST;
+  g = game_new_ext(1, len, shapes, orientations, false);
+  ok = ok && game_is_connected(g);
+  game_set_piece_orientation(g, 0, len / 2, NORTH);  // coupe le chemin
+  ok = ok && !game_is_connected(g);
+  game_delete(g);
+  free(shapes);
+  free(orientations);
+  return ok;
+}
+
+bool test_game_is_connected_wide(void) {
+  // Grille de 64 colonnes avec wrapping : le chemin fait le tour de la ligne
+  uint n = 64;
+  shape shapes[2 * 64];
+  direction orientations[2 * 64];
+  for (uint k = 0; k < 2 * n; k++) {
+    shapes[k] = (k < n) ? SEGMENT : EMPTY;
+    orientations[k] = EAST;
+  }
+  game g = game_new_ext(2, n, shapes, orientations, true);
+  bool ok = game_is_connected(g) && game_won(g);
+
+  // Une ligne coupée par une case vide reste connectée par le bord opposé
+  game_set_piece_shape(g, 0, 10, EMPTY);
+  ok = ok && game_is_connected(g);
+  game_set_piece_shape(g, 0, 40, EMPTY);
+  ok = ok && !game_is_connected(g);
+  game_delete(g);
+
+  // Comparaison avec le nombre de composantes, avant et après mélange
+  game games[3] = {game_random(4, 7, true, 2, 3), game_random(6, 6, false, 3, 4),
+                   game_random(2, 5, true, 0, 2)};
+  for (uint k = 0; k < 3; k++) {
+    ok = ok && game_is_connected(games[k]);
+    game_shuffle_orientation(games[k]);
+    ok = ok && game_is_connected(games[k]) ==
+                   (game_nb_components(games[k]) <= 1);
+    game_delete(games[k]);
+  }
+  return ok;
+}
+
+bool test_game_large_grid(void) {
+  // Taille au-delà de 2^32 cases, calculée sans dépassement
+  bool ok = game_memory_size(100000, 100000) > 10000000000ULL;
+
+  // Grille sans table des voisins : un anneau de 4 coins autour du bord
+  uint n = 4100;
+  game g = game_new_empty_ext(n, n, true);
+  game_set_piece_shape(g, n - 1, n - 1, CORNER);
+  game_set_piece_shape(g, n - 1, 0, CORNER);
+  game_set_piece_shape(g, 0, 0, CORNER);
+  game_set_piece_shape(g, 0, n - 1, CORNER);
+  game_set_piece_orientation(g, n - 1, n - 1, EAST);
+  game_set_piece_orientation(g, n - 1, 0, SOUTH);
+  game_set_piece_orientation(g, 0, 0, WEST);
+  game_set_piece_orientation(g, 0, n - 1, NORTH);
+  ok = ok && game_is_well_paired(g) && game_is_connected(g);
+  uint pi, pj;
+  ok = ok && game_get_ajacent_square(g, 0, 0, NORTH, &pi, &pj) &&
+       pi == n - 1 && pj == 0;
+  game_play_move(g, 0, 0, 1);
+  ok = ok && !game_won(g);
+  game_undo(g);
+  ok = ok && game_won(g);
+  game_delete(g);
+  return ok;
+}
+
+bool test_game_wide_grid(void) {
+  // Grille assez large pour être rangée par tuiles : chaque ligne est un
+  // anneau de segments, sauf la première colonne faite de croix
+  uint nb_rows = 20, nb_cols = 1030;
+  shape *shapes = malloc(nb_rows * nb_cols * sizeof(shape));
+  direction *orientations = malloc(nb_rows * nb_cols * sizeof(direction));
+  assert(shapes != NULL && orientations != NULL);
+  for (uint k = 0; k < nb_rows * nb_cols; k++) {
+    shapes[k] = SEGMENT;
+    orientations[k] = EAST;
+  }
+  game g = game_new_ext(nb_rows, nb_cols, shapes, orientations, true);
+  bool ok = game_is_well_paired(g) && !game_is_connected(g) &&
+            game_nb_components(g) == nb_rows;
+  for (uint i = 0; i < nb_rows; i++) {
+    game_set_piece_shape(g, i, 0, CROSS);
+  }
+  ok = ok && game_won(g) && game_get_piece_shape(g, 17, 0) == CROSS &&
+       game_get_piece_shape(g, 17, 1029) == SEGMENT;
+
+  // Voisins de part et d'autre des bords de tuiles
+  uint pi, pj;
+  ok = ok && game_get_ajacent_square(g, 15, 15, SOUTH, &pi, &pj) &&
+       pi == 16 && pj == 15;
+  ok = ok && game_get_ajacent_square(g, 16, 16, WEST, &pi, &pj) &&
+       pi == 16 && pj == 15;
+  ok = ok && game_get_ajacent_square(g, 19, 1029, EAST, &pi, &pj) &&
+       pi == 19 && pj == 0;
+  ok = ok && game_get_ajacent_square(g, 0, 1029, NORTH, &pi, &pj) &&
+       pi == 19 && pj == 1029;
+
+  // Les tableaux échangés avec l'appelant restent rangés ligne par ligne
+  game_save_orientations(g, orientations);
+  ok = ok && orientations[17 * nb_cols + 1029] == EAST;
+  orientations[17 * nb_cols + 1029] = WEST;
+  game_restore_orientations(g, orientations);
+  ok = ok && game_get_piece_orientation(g, 17, 1029) == WEST && game_won(g);
+
+  // Sauvegarde et chargement
+  game_play_move(g, 3, 500, 1);
+  game_save(g, "wide.txt");
+  game g_loaded = game_load("wide.txt");
+  ok = ok && g_loaded != NULL && game_equal(g, g_loaded, false) &&
+       !game_won(g_loaded);
+
+  game_delete(g);
+  game_delete(g_loaded);
+  free(shapes);
+  free(orientations);
+  return ok;
+}
+
+// Jeu reconstruit à partir des accesseurs : ses compteurs sont recalculés
+// entièrement, sans rien reprendre du jeu d'origine
+static game _rebuild(cgame g) {
+  uint nb_rows = game_nb_rows(g);
+  uint nb_cols = game_nb_cols(g);
+  shape *shapes = malloc(nb_rows * nb_cols * sizeof(shape));
+  direction *orientations = malloc(nb_rows * nb_cols * sizeof(direction));
+  assert(shapes != NULL && orientations != NULL);
+  for (uint i = 0; i < nb_rows; i++) {
+    for (uint j = 0; j < nb_cols; j++) {
+      shapes[i * nb_cols + j] = game_get_piece_shape(g, i, j);
+      orientations[i * nb_cols + j] = game_get_piece_orientation(g, i, j);
+    }
+  }
+  game g_rebuilt = game_new_ext(nb_rows, nb_cols, shapes, orientations,
+                                game_is_wrapping(g));
+  free(shapes);
+  free(orientations);
+  return g_rebuilt;
+}
+
+bool test_game_nb_components(void) {
+  bool test = true;
+
+  // Valeurs connues : jeu vide, solution (connexe) et jeu par défaut
+  game g_empty = game_new_empty();
+  game g_solution = game_default_solution();
+  if (game_nb_components(g_empty) != 0 || game_nb_components(g_solution) != 1) {
+    printf("Erreur : nombre de composantes du jeu vide ou de la solution.\n");
+    test = false;
+  }
+  game_delete(g_empty);
+
+  // Le suivi incrémental doit toujours donner le même résultat qu'un calcul
+  // complet sur un jeu reconstruit, quels que soient les coups joués
+  game games[3] = {g_solution, game_random(2, 5, true, 0, 2),
+                   game_random(6, 6, false, 3, 4)};
+  for (uint k = 0; k < 3; k++) {
+    game g = games[k];
+    game_track_connectivity(g, true);
+    for (uint n = 0; n < 300; n++) {
+      uint i = rand() % game_nb_rows(g);
+      uint j = rand() % game_nb_cols(g);
+      if (n % 17 == 0) {
+        game_set_piece_shape(g, i, j, rand() % NB_SHAPES);
+      } else if (n % 19 == 0) {
+        game_undo(g);
+      } else {
+        game_play_move(g, i, j, rand() % 4);
+      }
+      game g_rebuilt = _rebuild(g);
+      if (game_nb_components(g) != game_nb_components(g_rebuilt) ||
+          game_is_connected(g) != game_is_connected(g_rebuilt) ||
+          game_won(g) != game_won(g_rebuilt)) {
+        printf("Erreur : composantes incorrectes après %u coups (jeu %u).\n",
+               n, k);
+        test = false;
+      }
+      game_delete(g_rebuilt);
+    }
+    game_track_connectivity(g, false);
+    game_delete(g);
+  }
+
+  return test;
+}
+
+bool test_game_hash(void) {
+  game g = game_default();
+  game g_default = game_default();
+  game g_copy = game_copy(g);
+  uint64_t h = game_hash(g);
+  bool ok = game_hash(g_default) == h && game_hash(g_copy) == h;
+
+  // Un coup change l'empreinte, l'annuler ou faire un tour complet la rétablit
+  game_play_move(g, 1, 1, 1);
+  ok = ok && game_hash(g) != h && !game_equal(g, g_default, false);
+  game_undo(g);
+  ok = ok && game_hash(g) == h;
+  game_play_move(g, 2, 2, 2);
+  game_play_move(g, 2, 2, 2);
+  ok = ok && game_hash(g) == h && game_equal(g, g_default, false);
+
+  // Les modifications directes sont prises en compte
+  game_set_piece_shape(g, 0, 0, CROSS);
+  ok = ok && game_hash(g) != h;
+  game_set_piece_shape(g, 0, 0, game_get_piece_shape(g_default, 0, 0));
+  ok = ok && game_hash(g) == h;
+  game_set_piece_orientation(g, 4, 4, EAST);
+  ok = ok && game_hash(g) != h;
+
+  // Même état obtenu par des chemins différents
+  game_reset_orientation(g);
+  game_reset_orientation(g_copy);
+  ok = ok && game_hash(g) == game_hash(g_copy);
+
+  game_delete(g);
+  game_delete(g_default);
+  game_delete(g_copy);
+  return ok;
+}
+
 bool test_game_undo(void) {
   // On créé 2 jeux par défault, on en modifie un et on regarde s'ils sont égaux
   // après annulation de l'action
@@ -417,11 +665,111 @@ bool test_game_undo(void) {
   game_undo(g);
 
   bool equal = game_equal(g, g_default, false);
+
+  // Plusieurs coups, avec des rotations négatives ou de plus d'un tour, puis
+  // annulation de tous les coups
+  game_play_move(g, 0, 0, -1);
+  game_play_move(g, 2, 3, 5);
+  game_play_move(g, 0, 0, 2);
+  game_play_move(g, 4, 1, -7);
+  for (uint k = 0; k < 4; k++) {
+    game_undo(g);
+  }
+  equal = equal && game_equal(g, g_default, false);
+
   game_delete(g);
   game_delete(g_default);
   return equal;
 }
 
+bool test_game_undo_write(void) {
+  // Les écritures qui ne sont pas des coups sont annulées avec le dernier
+  // coup, comme lorsque l'annulation restaurait une copie complète du jeu
+  game g = game_default();
+  game g_default = game_default();
+  game_play_move(g, 0, 0, 1);
+  game g_first = game_copy(g);
+  game_play_move(g, 1, 1, 1);
+  game_set_piece_shape(g, 2, 2, CROSS);
+  game_set_piece_orientation(g, 3, 3, WEST);
+  game_shuffle_orientation(g);
+  game g_last = game_copy(g);
+  game_undo(g);
+  bool ok = game_equal(g, g_first, false);
+  game_redo(g);
+  ok = ok && game_equal(g, g_last, false);
+
+  // De même pour une résolution
+  game_undo(g);
+  ok = ok && game_solve(g) && game_won(g);
+  game_undo(g);
+  ok = ok && game_equal(g, g_default, false);
+  game_redo(g);
+  ok = ok && game_won(g);
+
+  // Sans coup à annuler, l'écriture reste
+  game g_empty = game_new_empty();
+  game_set_piece_shape(g_empty, 0, 0, ENDPOINT);
+  game_undo(g_empty);
+  ok = ok && game_get_piece_shape(g_empty, 0, 0) == ENDPOINT;
+
+  game_delete(g);
+  game_delete(g_default);
+  game_delete(g_first);
+  game_delete(g_last);
+  game_delete(g_empty);
+  return ok;
+}
+
+bool test_game_play_moves(void) {
+  game g = game_default();
+  game g_default = game_default();
+  game g_solution = game_default_solution();
+
+  // Les mêmes coups un par un ou en lot donnent le même jeu
+  move moves[3] = {{0, 0, 1}, {2, 3, -1}, {4, 4, 6}};
+  game g_single = game_default();
+  for (uint k = 0; k < 3; k++) {
+    game_play_move(g_single, moves[k].i, moves[k].j, moves[k].nb_quarter_turns);
+  }
+  bool won = true;
+  game_play_moves(g, moves, 3, true, &won);
+  bool ok = !won && game_equal(g, g_single, false);
+
+  // Un lot groupé est annulé et rejoué en une fois
+  game_undo(g);
+  ok = ok && game_equal(g, g_default, false);
+  game_redo(g);
+  ok = ok && game_equal(g, g_single, false);
+
+  // Sans regroupement, chaque coup est annulé séparément
+  game_play_moves(g, moves, 3, false, NULL);
+  game_undo(g);
+  game_undo(g);
+  game_undo(g);
+  ok = ok && game_equal(g, g_single, false);
+
+  // Jouer la solution à partir du jeu par défaut
+  game_reset_orientation(g);
+  move solution[25];
+  uint nb = 0;
+  for (uint i = 0; i < 5; i++) {
+    for (uint j = 0; j < 5; j++) {
+      int turns = (int)game_get_piece_orientation(g_solution, i, j) -
+                  (int)game_get_piece_orientation(g, i, j);
+      solution[nb++] = (move){i, j, turns};
+    }
+  }
+  game_play_moves(g, solution, nb, true, &won);
+  ok = ok && won;
+
+  game_delete(g);
+  game_delete(g_single);
+  game_delete(g_default);
+  game_delete(g_solution);
+  return ok;
+}
+
 bool test_game_redo(void) {
   // On créé un jeu par défault, on le modifie puis on le copie et on regarde si
   // après un undo et redo il est égal à sa version innitiale
@@ -440,6 +788,521 @@ bool test_game_redo(void) {
   return equal;
 }
 
+bool test_game_history_limit(void) {
+  // Historique limité à 2 coups : seuls les 2 derniers coups sont annulables
+  game g = game_default();
+  game_set_history_limit(g, 2, 0);
+  game_play_move(g, 0, 0, 1);
+  game g_first = game_copy(g);
+  game_play_move(g, 1, 1, 1);
+  game_play_move(g, 2, 2, 1);
+  size_t two_moves = game_history_size(g);
+  bool ok = two_moves > 0;
+  for (uint k = 0; k < 3; k++) {
+    game_undo(g);
+  }
+  ok = ok && game_equal(g, g_first, false);
+  ok = ok && game_history_size(g) == two_moves;  // les coups sont dans redo
+
+  // Une limite en octets plus stricte réduit l'historique immédiatement
+  game_set_history_limit(g, 0, two_moves / 2);
+  ok = ok && game_history_size(g) == two_moves / 2;
+
+  // Un lot groupé plus long que la limite est annulé en entier
+  game_set_history_limit(g, 2, 0);
+  game g_before = game_copy(g);
+  move moves[4] = {{0, 0, 1}, {1, 1, 1}, {2, 2, 1}, {3, 3, 1}};
+  game_play_moves(g, moves, 4, true, NULL);
+  game_undo(g);
+  ok = ok && game_equal(g, g_before, false);
+  game_redo(g);
+  game_undo(g);
+  ok = ok && game_equal(g, g_before, false);
+
+  // La réinitialisation vide l'historique
+  game_reset_orientation(g);
+  ok = ok && game_history_size(g) == 0;
+  game_delete(g);
+  game_delete(g_first);
+  game_delete(g_before);
+  return ok;
+}
+
+bool test_game_new_empty_at(void) {
+  // Plusieurs jeux construits successivement dans le même bloc mémoire
+  game g_default = game_default();
+  void *buffer = malloc(game_memory_size(5, 5));
+  assert(buffer != NULL);
+  bool ok = game_memory_size(5, 5) > game_memory_size(2, 3);
+
+  for (uint k = 0; k < 3; k++) {
+    game g = game_new_empty_at(buffer, 5, 5, false);
+    ok = ok && (void *)g == buffer && game_nb_rows(g) == 5 &&
+         game_nb_cols(g) == 5 && game_get_piece_shape(g, 2, 2) == EMPTY;
+    for (uint i = 0; i < 5; i++) {
+      for (uint j = 0; j < 5; j++) {
+        game_set_piece_shape(g, i, j, game_get_piece_shape(g_default, i, j));
+        game_set_piece_orientation(g, i, j,
+                                   game_get_piece_orientation(g_default, i, j));
+      }
+    }
+    ok = ok && game_equal(g, g_default, false);
+    game_play_move(g, 0, 0, 1);
+    game_undo(g);
+    ok = ok && game_equal(g, g_default, false);
+    game_delete(g);  // ne libère pas le bloc
+  }
+
+  // Un jeu plus petit tient dans le même bloc
+  game g = game_new_empty_at(buffer, 2, 3, true);
+  ok = ok && game_is_wrapping(g) && game_nb_cols(g) == 3;
+  game_delete(g);
+
+  // Jeux aux dimensions d'un modèle, qui peut être supprimé avant eux
+  game g_model = game_new_empty_ext(5, 5, false);
+  for (uint k = 0; k < 3; k++) {
+    g = game_new_empty_like_at(buffer, g_model);
+    if (k == 2) {
+      game_delete(g_model);
+    }
+    ok = ok && (void *)g == buffer && game_nb_rows(g) == 5 &&
+         game_nb_cols(g) == 5 && !game_is_wrapping(g);
+    for (uint i = 0; i < 5; i++) {
+      for (uint j = 0; j < 5; j++) {
+        game_set_piece_shape(g, i, j, game_get_piece_shape(g_default, i, j));
+        game_set_piece_orientation(g, i, j,
+                                   game_get_piece_orientation(g_default, i, j));
+      }
+    }
+    ok = ok && game_equal(g, g_default, false) && !game_won(g);
+    game_delete(g);
+  }
+
+  free(buffer);
+  game_delete(g_default);
+  return ok;
+}
+
+bool test_game_copy_shared(void) {
+  // Une copie partage la table des voisins de l'original, et lui survit
+  game g = game_default();
+  game g_copy = game_copy(g);
+  game g_copy2 = game_copy(g_copy);
+  bool ok = game_equal(g_copy, g, false) && game_equal(g_copy2, g, false);
+  uint nb_components = game_nb_components(g);
+  game_delete(g);
+  ok = ok && game_nb_components(g_copy) == nb_components &&
+       game_nb_components(g_copy2) == nb_components;
+
+  // Les cases restent propres à chaque copie
+  game_play_move(g_copy, 0, 0, 1);
+  ok = ok && !game_equal(g_copy, g_copy2, false);
+  uint pi, pj;
+  ok = ok && game_get_ajacent_square(g_copy, 0, 0, EAST, &pi, &pj) &&
+       pi == 0 && pj == 1;
+  game_set_piece_shape(g_copy2, 2, 2, CROSS);
+  ok = ok && game_get_piece_shape(g_copy, 2, 2) != CROSS;
+
+  game_delete(g_copy);
+  game_delete(g_copy2);
+  return ok;
+}
+
+bool test_game_snapshot(void) {
+  // Instantané, coups joués, puis restauration
+  game g = game_default();
+  snapshot s = game_snapshot(g);
+  game_play_move(g, 0, 0, 1);
+  game_play_move(g, 4, 4, 3);
+  game_restore_snapshot(g, s);
+  game g_default = game_default();
+  bool ok = game_equal(g, g_default, false) &&
+            game_hash(g) == game_hash(g_default) && !game_won(g);
+
+  // La restauration est annulée avec le dernier coup, puis rejouée avec lui
+  game g_first = game_default();
+  game_play_move(g_first, 0, 0, 1);
+  game_undo(g);
+  ok = ok && game_equal(g, g_first, false);
+  game_redo(g);
+  ok = ok && game_equal(g, g_default, false);
+  game_delete(g_first);
+
+  // Un jeu issu d'un instantané est indépendant, et partage les voisins
+  game g_fork = game_fork(s);
+  ok = ok && game_equal(g_fork, g_default, false) &&
+       game_hash(g_fork) == game_hash(g_default) &&
+       game_nb_components(g_fork) == game_nb_components(g_default);
+  game_play_move(g_fork, 0, 0, 1);
+  ok = ok && !game_equal(g_fork, g, false);
+  snapshot_delete(s);
+  game_delete(g_fork);
+  game_delete(g_default);
+  game_delete(g);
+
+  // Grande grille : les instantanés successifs ne diffèrent que par la case
+  // jouée entre eux
+  g = game_new_empty_ext(1000, 1000, false);
+  game_set_piece_shape(g, 999, 999, ENDPOINT);
+  snapshot s1 = game_snapshot(g);
+  game_play_move(g, 999, 999, 1);
+  snapshot s2 = game_snapshot(g);
+  game g1 = game_fork(s1);
+  game g2 = game_fork(s2);
+  ok = ok && game_diff(g1, g2, NULL, NULL) == 1 &&
+       game_hash(g2) == game_hash(g);
+  game_delete(g1);
+  game_delete(g2);
+
+  // Restauration, et jeu issu d'un instantané, qui survit à l'original
+  game_restore_snapshot(g, s1);
+  ok = ok && game_get_piece_orientation(g, 999, 999) == NORTH;
+  g_fork = game_fork(s2);
+  snapshot_delete(s1);
+  snapshot_delete(s2);
+  game_delete(g);
+  ok = ok && game_get_piece_orientation(g_fork, 999, 999) == EAST &&
+       game_get_piece_shape(g_fork, 999, 999) == ENDPOINT;
+  game_delete(g_fork);
+  return ok;
+}
+
+bool test_game_cells_view(void) {
+  // La vue donne les cases sans copie, ligne par ligne
+  game g = game_default();
+  game_view view = game_cells_view(g);
+  bool ok = view.nb_rows == 5 && view.nb_cols == 5 && view.stride == 5;
+  for (uint i = 0; i < 5; i++) {
+    for (uint j = 0; j < 5; j++) {
+      unsigned char c = view.cells[i * view.stride + j];
+      direction o = game_get_piece_orientation(g, i, j);
+      ok = ok && GAME_VIEW_ORIENTATION(c) == o &&
+           GAME_VIEW_MASK(c) == game_get_piece_mask(g, i, j) &&
+           game_view_shape(c) == game_get_piece_shape(g, i, j);
+    }
+  }
+
+  // La génération change à chaque modification, et seulement dans ce cas
+  uint64_t generation = game_generation(g);
+  ok = ok && view.generation == generation;
+  game_won(g);
+  game_get_piece_shape(g, 0, 0);
+  ok = ok && game_generation(g) == generation;
+  game_play_move(g, 0, 0, 1);
+  ok = ok && game_generation(g) > generation &&
+       GAME_VIEW_ORIENTATION(view.cells[0]) ==
+           game_get_piece_orientation(g, 0, 0);
+  generation = game_generation(g);
+  game_undo(g);
+  ok = ok && game_generation(g) > generation;
+  generation = game_generation(g);
+  game_shuffle_orientation(g);
+  ok = ok && game_generation(g) > generation;
+  game_delete(g);
+
+  // Cases rangées par tuiles : pas de pas entre les lignes
+  g = game_new_empty_ext(1, TILED_MIN_COLS, false);
+  ok = ok && game_cells_view(g).stride == 0;
+  game_delete(g);
+  return ok;
+}
+
+bool test_game_fixed_kernels(void) {
+  // Les noyaux spécialisés des grilles carrées courantes donnent les mêmes
+  // résultats que le suivi incrémental de la connexité et le comptage par arête
+  bool ok = true;
+  uint sizes[] = {4, 5, 7, 9};
+  srand(42);
+  for (uint t = 0; t < 40; t++) {
+    uint n = sizes[t % 4];
+    bool wrapping = (t / 4) % 2;
+    game g = (n < 9 && !wrapping) ? game_random(n, n, false, 0, 0)
+                                  : game_new_empty_ext(n, n, wrapping);
+    for (uint k = 0; n == 9 && k < n * n; k++) {
+      game_set_piece_shape(g, k / n, k % n, rand() % NB_SHAPES);
+    }
+    for (uint pass = 0; pass < 2; pass++) {
+      game_track_connectivity(g, false);
+      bool connected = game_is_connected(g);
+      game_track_connectivity(g, true);
+      ok = ok && connected == (game_nb_components(g) <= 1);
+
+      size_t count = 0;
+      for (uint i = 0; i < n; i++) {
+        for (uint j = 0; j < n; j++) {
+          for (direction d = 0; d < NB_DIRS; d++) {
+            count += game_has_half_edge(g, i, j, d) &&
+                     game_check_edge(g, i, j, d) != MATCH;
+          }
+        }
+      }
+      ok = ok && game_is_well_paired(g) == (count == 0);
+      game_shuffle_orientation(g);
+    }
+
+    // Recherche spécialisée : un jeu aléatoire mélangé est toujours résolu
+    if (n < 9 && !wrapping) {
+      ok = ok && game_solve(g) && game_won(g) && game_nb_components(g) == 1;
+    }
+    game_delete(g);
+  }
+  return ok;
+}
+
+bool test_game_piece_mask(void) {
+  // Chaque masque donne une pièce qui a exactement ces demi-arêtes
+  game g = game_new_empty_ext(2, 2, false);
+  bool ok = true;
+  for (uint mask = 0; mask < 16; mask++) {
+    game_set_piece_mask(g, 0, 1, mask);
+    ok = ok && game_get_piece_mask(g, 0, 1) == mask;
+    for (direction d = 0; d < NB_DIRS; d++) {
+      ok = ok &&
+           game_has_half_edge(g, 0, 1, d) == ((mask & (0b1000 >> d)) != 0);
+    }
+  }
+  game_set_piece_mask(g, 0, 1, 0b0101);
+  ok = ok && game_get_piece_shape(g, 0, 1) == SEGMENT &&
+       game_get_piece_orientation(g, 0, 1) == EAST;
+
+  // Construction d'un jeu gagné demi-arête par demi-arête
+  game_set_piece_mask(g, 0, 1, 0);
+  game_add_half_edge(g, 0, 0, EAST);
+  game_add_half_edge(g, 0, 1, WEST);
+  ok = ok && game_won(g) && game_get_piece_shape(g, 0, 0) == ENDPOINT;
+  game_add_half_edge(g, 0, 0, SOUTH);
+  game_add_half_edge(g, 1, 0, NORTH);
+  ok = ok && game_won(g) && game_get_piece_mask(g, 0, 0) == 0b0110 &&
+       game_get_piece_shape(g, 0, 0) == CORNER &&
+       game_get_piece_orientation(g, 0, 0) == EAST;
+  game_add_half_edge(g, 1, 0, EAST);
+  ok = ok && !game_won(g) && !game_is_well_paired(g);
+  game_add_half_edge(g, 1, 1, WEST);
+  ok = ok && game_won(g);
+  game_delete(g);
+  return ok;
+}
+
+// Nombre de fils et de jeux par fil du test de concurrence
+#define NB_THREADS 8
+#define NB_GAMES_PER_THREAD 250
+
+typedef struct {
+  cgame shared;  // jeu lu par tous les fils, copié par chacun
+  uint64_t seed;
+  bool ok;
+} thread_args;
+
+static void *_thread_games(void *arg) {
+  thread_args *args = arg;
+  uint64_t rng = args->seed;
+  args->ok = true;
+  for (uint k = 0; k < NB_GAMES_PER_THREAD; k++) {
+    // Copie du jeu partagé : sa table des voisins est partagée entre les fils
+    game g = game_copy(args->shared);
+    snapshot s = game_snapshot(g);
+    game_shuffle_orientation_r(g, &rng);
+    args->ok = args->ok && game_solve(g) && game_won(g);
+    game_restore_snapshot(g, s);
+    args->ok = args->ok && game_equal(g, args->shared, false);
+    snapshot_delete(s);
+    game_delete(g);
+
+    // Jeu propre au fil, reproductible à partir de son générateur
+    uint64_t replay = rng;
+    g = game_random_r(5, 5, k % 2, 0, 2, &rng);
+    game h = game_random_r(5, 5, k % 2, 0, 2, &replay);
+    args->ok = args->ok && game_equal(g, h, false) && game_won(g);
+    game_track_connectivity(g, true);
+    game_shuffle_orientation_r(g, &rng);
+    args->ok = args->ok && game_solve(g) && game_nb_components(g) == 1;
+    game_delete(h);
+    game_delete(g);
+  }
+  return NULL;
+}
+
+bool test_game_threads(void) {
+  // Des milliers de jeux joués en parallèle, sans état global partagé
+  game shared = game_default_solution();
+  pthread_t threads[NB_THREADS];
+  thread_args args[NB_THREADS];
+  for (uint t = 0; t < NB_THREADS; t++) {
+    args[t].shared = shared;
+    args[t].seed = t + 1;
+    if (pthread_create(&threads[t], NULL, _thread_games, &args[t]) != 0) {
+      return false;
+    }
+  }
+  bool ok = true;
+  for (uint t = 0; t < NB_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+    ok = ok && args[t].ok;
+  }
+  // Le jeu partagé, dont toutes les copies sont supprimées, reste intact
+  game g_solution = game_default_solution();
+  ok = ok && game_equal(shared, g_solution, false) && game_won(shared);
+  game_delete(g_solution);
+  game_delete(shared);
+  return ok;
+}
+
+// Messages reçus par _count_messages, par niveau
+static uint nb_messages[GAME_LOG_NONE];
+
+static void _count_messages(game_log_level level, const char *message,
+                            void *user_data) {
+  nb_messages[level]++;
+  snprintf(user_data, 64, "%s", message);  // le message n'est valide qu'ici
+}
+
+bool test_game_log(void) {
+  char last[64] = "";
+  game_log_set_callback(_count_messages, last);
+  bool ok = game_log_get_level() == GAME_LOG_WARNING;
+
+  // Par défaut, seuls les avertissements et les erreurs sont transmis
+  game g = game_new_empty();
+  game_undo(g);
+  game_play_move(g, 0, 0, 1);
+  ok = ok && nb_messages[GAME_LOG_INFO] == 0 &&
+       nb_messages[GAME_LOG_WARNING] == 1 &&
+       strcmp(last, "EMPTY piece at (0, 0), no changes made.") == 0;
+
+  // Tous les niveaux, puis aucun
+  game_log_set_level(GAME_LOG_DEBUG);
+  game_set_piece_shape(g, 0, 0, CROSS);
+  game_play_move(g, 0, 0, 1);
+  game_undo(g);
+  game_redo(g);
+  game_redo(g);
+  ok = ok && nb_messages[GAME_LOG_DEBUG] == 2 &&
+       nb_messages[GAME_LOG_INFO] == 1;
+  game_log_set_level(GAME_LOG_NONE);
+  game_play_move(g, 1, 1, 1);
+  game_undo(g);
+  ok = ok && nb_messages[GAME_LOG_WARNING] == 1 &&
+       nb_messages[GAME_LOG_DEBUG] == 2;
+
+  // Sans fonction, les messages sont ignorés
+  game_log_set_level(GAME_LOG_DEBUG);
+  game_log_set_callback(NULL, NULL);
+  game_play_move(g, 1, 1, 1);
+  ok = ok && nb_messages[GAME_LOG_WARNING] == 1;
+  game_delete(g);
+  game_log_set_level(GAME_LOG_WARNING);
+  return ok;
+}
+
+// Cases reçues par _record_diff, dans l'ordre
+typedef struct {
+  uint nb;
+  uint i[8], j[8];
+  shape s[8];
+  direction o[8];
+} diff_list;
+
+static void _record_diff(uint i, uint j, shape s, direction o,
+                         void *user_data) {
+  diff_list *list = user_data;
+  if (list->nb < 8) {
+    list->i[list->nb] = i;
+    list->j[list->nb] = j;
+    list->s[list->nb] = s;
+    list->o[list->nb] = o;
+  }
+  list->nb++;
+}
+
+bool test_game_diff(void) {
+  // Jeux égaux : aucune différence
+  game g1 = game_default();
+  game g2 = game_default();
+  diff_list list = {0};
+  bool ok = game_diff(g1, g2, _record_diff, &list) == 0 && list.nb == 0;
+
+  // Seules les cases modifiées sont signalées, avec leur valeur dans b
+  game_play_move(g2, 0, 0, 1);
+  game_set_piece_shape(g2, 4, 3, CROSS);
+  ok = ok && game_diff(g1, g2, _record_diff, &list) == 2 && list.nb == 2 &&
+       list.i[0] == 0 && list.j[0] == 0 && list.s[0] == CORNER &&
+       list.o[0] == NORTH && list.i[1] == 4 && list.j[1] == 3 &&
+       list.s[1] == CROSS;
+  ok = ok && game_diff(g2, g1, NULL, NULL) == 2;
+
+  // Tout le jeu, dans l'ordre des lignes
+  game_shuffle_orientation(g2);
+  size_t count = 0;
+  for (uint i = 0; i < 5; i++) {
+    for (uint j = 0; j < 5; j++) {
+      count +=
+          game_get_piece_shape(g1, i, j) != game_get_piece_shape(g2, i, j) ||
+          game_get_piece_orientation(g1, i, j) !=
+              game_get_piece_orientation(g2, i, j);
+    }
+  }
+  ok = ok && game_diff(g1, g2, NULL, NULL) == count;
+  game_delete(g1);
+  game_delete(g2);
+
+  // Grille rangée par tuiles : coordonnées retrouvées
+  g1 = game_new_empty_ext(20, TILED_MIN_COLS, false);
+  g2 = game_copy(g1);
+  game_set_piece_shape(g2, 17, TILED_MIN_COLS - 1, ENDPOINT);
+  list.nb = 0;
+  ok = ok && game_diff(g1, g2, _record_diff, &list) == 1 && list.i[0] == 17 &&
+       list.j[0] == TILED_MIN_COLS - 1 && list.s[0] == ENDPOINT;
+  game_delete(g1);
+  game_delete(g2);
+  return ok;
+}
+
+bool test_game_copy_into(void) {
+  // Copie dans un jeu existant, avec suivi de la connexité et historique
+  game g = game_default_solution();
+  game g_copy = game_default();
+  game_track_connectivity(g_copy, true);
+  game_play_move(g_copy, 0, 0, 1);
+  game_copy_into(g_copy, g);
+
+  bool ok = game_equal(g, g_copy, false) && game_won(g_copy) &&
+            game_nb_components(g_copy) == 1 && game_history_size(g_copy) == 0;
+
+  // Les deux jeux restent indépendants
+  game_play_move(g_copy, 0, 0, 1);
+  ok = ok && !game_equal(g, g_copy, false) && !game_won(g_copy);
+
+  game_delete(g);
+  game_delete(g_copy);
+  return ok;
+}
+
+bool test_game_save_orientations(void) {
+  // Sauvegarde des orientations, modification, puis restauration
+  game g = game_default();
+  game g_default = game_default();
+  direction saved[25];
+  game_save_orientations(g, saved);
+  bool ok = saved[0] == game_get_piece_orientation(g, 0, 0) &&
+            saved[24] == game_get_piece_orientation(g, 4, 4);
+
+  game_shuffle_orientation(g);
+  game_play_move(g, 1, 1, 1);
+  game_restore_orientations(g, saved);
+  ok = ok && game_equal(g, g_default, false);
+
+  // Restauration d'une solution : le jeu est gagné
+  game g_solution = game_default_solution();
+  game_save_orientations(g_solution, saved);
+  game_restore_orientations(g, saved);
+  ok = ok && game_won(g);
+
+  game_delete(g);
+  game_delete(g_default);
+  game_delete(g_solution);
+  return ok;
+}
+
 bool test_game_random(void) {
   // Test de la fonction game_random
   uint nb_rows = 3;
@@ -624,6 +1487,54 @@ int main(int argc, char *argv[]) {
       printf("test_game_is_well_paired FAILED\n");
       return EXIT_FAILURE;
     }
+  } else if (strcmp(argv[1], "test_game_is_connected_large") == 0) {
+    if (test_game_is_connected_large()) {
+      printf("test_game_is_connected_large PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_is_connected_large FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_is_connected_wide") == 0) {
+    if (test_game_is_connected_wide()) {
+      printf("test_game_is_connected_wide PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_is_connected_wide FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_large_grid") == 0) {
+    if (test_game_large_grid()) {
+      printf("test_game_large_grid PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_large_grid FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_wide_grid") == 0) {
+    if (test_game_wide_grid()) {
+      printf("test_game_wide_grid PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_wide_grid FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_nb_components") == 0) {
+    if (test_game_nb_components()) {
+      printf("test_game_nb_components PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_nb_components FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_hash") == 0) {
+    if (test_game_hash()) {
+      printf("test_game_hash PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_hash FAILED\n");
+      return EXIT_FAILURE;
+    }
   } else if (strcmp(argv[1], "test_game_undo") == 0) {
     if (test_game_undo()) {
       printf("test_game_undo PASSED\n");
@@ -632,6 +1543,22 @@ int main(int argc, char *argv[]) {
       printf("test_game_undo FAILED\n");
       return EXIT_FAILURE;
     }
+  } else if (strcmp(argv[1], "test_game_undo_write") == 0) {
+    if (test_game_undo_write()) {
+      printf("test_game_undo_write PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_undo_write FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_play_moves") == 0) {
+    if (test_game_play_moves()) {
+      printf("test_game_play_moves PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_play_moves FAILED\n");
+      return EXIT_FAILURE;
+    }
   } else if (strcmp(argv[1], "test_game_redo") == 0) {
     if (test_game_redo()) {
       printf("test_game_redo PASSED\n");
@@ -640,6 +1567,102 @@ int main(int argc, char *argv[]) {
       printf("test_game_redo FAILED\n");
       return EXIT_FAILURE;
     }
+  } else if (strcmp(argv[1], "test_game_history_limit") == 0) {
+    if (test_game_history_limit()) {
+      printf("test_game_history_limit PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_history_limit FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_new_empty_at") == 0) {
+    if (test_game_new_empty_at()) {
+      printf("test_game_new_empty_at PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_new_empty_at FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_copy_shared") == 0) {
+    if (test_game_copy_shared()) {
+      printf("test_game_copy_shared PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_copy_shared FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_snapshot") == 0) {
+    if (test_game_snapshot()) {
+      printf("test_game_snapshot PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_snapshot FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_cells_view") == 0) {
+    if (test_game_cells_view()) {
+      printf("test_game_cells_view PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_cells_view FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_fixed_kernels") == 0) {
+    if (test_game_fixed_kernels()) {
+      printf("test_game_fixed_kernels PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_fixed_kernels FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_piece_mask") == 0) {
+    if (test_game_piece_mask()) {
+      printf("test_game_piece_mask PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_piece_mask FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_threads") == 0) {
+    if (test_game_threads()) {
+      printf("test_game_threads PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_threads FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_log") == 0) {
+    if (test_game_log()) {
+      printf("test_game_log PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_log FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_diff") == 0) {
+    if (test_game_diff()) {
+      printf("test_game_diff PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_diff FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_copy_into") == 0) {
+    if (test_game_copy_into()) {
+      printf("test_game_copy_into PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_copy_into FAILED\n");
+      return EXIT_FAILURE;
+    }
+  } else if (strcmp(argv[1], "test_game_save_orientations") == 0) {
+    if (test_game_save_orientations()) {
+      printf("test_game_save_orientations PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("test_game_save_orientations FAILED\n");
+      return EXIT_FAILURE;
+    }
   } else if (strcmp(argv[1], "test_game_random") == 0) {
     if (test_game_random()) {
       printf("test_game_random PASSED\n");
@@ -152,6 +152,56 @@ bool test_game_won() {
   return true;
 }
 
+bool test_game_won_incremental(void) {
+  // Le résultat de game_won doit toujours correspondre à une vérification
+  // complète, quelle que soit la suite de coups joués
+  // Grille d'une seule ligne avec wrapping : chaque case est sa propre
+  // voisine au nord et au sud
+  shape shapes[1 * 4] = {ENDPOINT, SEGMENT, CORNER, TEE};
+  direction orientations[1 * 4] = {EAST, EAST, SOUTH, WEST};
+  game games[3] = {game_default(),
+                   game_new_ext(1, 4, shapes, orientations, true),
+                   game_random(4, 7, true, 2, 3)};
+  bool test = true;
+
+  for (uint k = 0; k < 3; k++) {
+    game g = games[k];
+    for (uint n = 0; n < 200; n++) {
+      uint i = rand() % game_nb_rows(g);
+      uint j = rand() % game_nb_cols(g);
+      if (n % 7 == 0) {
+        game_undo(g);
+      } else if (n % 11 == 0) {
+        game_redo(g);
+      } else if (n % 13 == 0) {
+        game_set_piece_shape(g, i, j, rand() % NB_SHAPES);
+      } else {
+        game_play_move(g, i, j, rand() % 7 - 3);
+      }
+      // Référence : demi-arêtes non appariées recomptées case par case,
+      // indépendamment du compteur incrémental
+      uint mismatches = 0;
+      for (uint a = 0; a < game_nb_rows(g); a++) {
+        for (uint b = 0; b < game_nb_cols(g); b++) {
+          for (direction d = 0; d < NB_DIRS; d++) {
+            mismatches += game_has_half_edge(g, a, b, d) &&
+                          game_check_edge(g, a, b, d) != MATCH;
+          }
+        }
+      }
+      bool expected = mismatches == 0 && game_is_connected(g);
+      if (game_is_well_paired(g) != (mismatches == 0) ||
+          game_won(g) != expected) {
+        printf("game_won mismatch after %u moves on game %u\n", n, k);
+        test = false;
+      }
+    }
+    game_delete(g);
+  }
+
+  return test;
+}
+
 bool test_game_reset_orientation(void) {
   game g = game_default();
 
@@ -347,6 +397,14 @@ int main(int argc, char* argv[]) {
       printf("\n**Test game_won FAILED**\n");
       return EXIT_FAILURE;
     }
+  } else if (strcmp(argv[1], "test_game_won_incremental") == 0) {
+    if (test_game_won_incremental()) {
+      printf("Test game_won_incremental PASSED\n");
+      return EXIT_SUCCESS;
+    } else {
+      printf("\n**Test game_won_incremental FAILED**\n");
+      return EXIT_FAILURE;
+    }
   } else if (strcmp(argv[1], "test_game_reset_orientation") == 0) {
     if (test_game_reset_orientation()) {
       printf("Test game_reset_orientation PASSED\n");
@@ -1,6 +1,7 @@
 #include "game_tools.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,6 +11,8 @@
 #include "game.h"
 #include "game_aux.h"
 #include "game_ext.h"
+#include "game_inline.h"
+#include "game_log.h"
 #include "game_struct.h"
 
 #define NB_DIRS 4
@@ -17,6 +20,7 @@
 typedef struct game_s* game;
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -90,73 +94,82 @@ direction char_to_direction(char c) {
 
 game game_load(char* filename) {
   if (filename == NULL) {
-    fprintf(stderr, "Filename is null\n");
+    GAME_LOG(GAME_LOG_ERROR, "Filename is null");
     return NULL;
   }
 
   FILE* f = fopen(filename, "r");
   if (f == NULL) {
-    fprintf(stderr, "Failed to open the file: %s\n", filename);
+    GAME_LOG(GAME_LOG_ERROR, "Failed to open the file: %s", filename);
     return NULL;
   }
 
   uint nb_rows, nb_cols;
   int wrapping_int;
   if (fscanf(f, "%u %u %d", &nb_rows, &nb_cols, &wrapping_int) != 3) {
-    fprintf(stderr, "Error reading game parameters\n");
+    GAME_LOG(GAME_LOG_ERROR, "Error reading game parameters");
     fclose(f);
     return NULL;
   }
   bool wrapping = (wrapping_int == 1);
+  if (game_memory_size(nb_rows, nb_cols) == 0) {
+    GAME_LOG(GAME_LOG_ERROR, "Game too large: %u x %u", nb_rows, nb_cols);
+    fclose(f);
+    return NULL;
+  }
   game g = game_new_empty_ext(nb_rows, nb_cols, wrapping);
   if (g == NULL) {
-    fprintf(stderr, "Failed to create a new empty game\n");
+    GAME_LOG(GAME_LOG_ERROR, "Failed to create a new empty game");
     fclose(f);
     return NULL;
   }
 
-  for (uint i = 0; i < nb_rows * nb_cols; i++) {
-    char shape_char, direction_char;
-    if (fscanf(f, " %c%c", &shape_char, &direction_char) != 2) {
-      fprintf(stderr, "Error while reading the file\n");
-      game_delete(g);
-      fclose(f);
-      return NULL;
-    }
+  for (uint i = 0; i < nb_rows; i++) {
+    for (uint j = 0; j < nb_cols; j++) {
+      char shape_char, direction_char;
+      if (fscanf(f, " %c%c", &shape_char, &direction_char) != 2) {
+        GAME_LOG(GAME_LOG_ERROR, "Error while reading the file");
+        game_delete(g);
+        fclose(f);
+        return NULL;
+      }
 
-    g->shapes[i] = char_to_shape(shape_char);
-    g->orientations[i] = char_to_direction(direction_char);
+      g->cells[_game_index(g, i, j)] = _cell_encode(
+          char_to_shape(shape_char), char_to_direction(direction_char));
+    }
   }
+  _game_refresh(g);
   fclose(f);
   return g;
 }
 
 void game_save(cgame g, char* filename) {
   if (g == NULL) {
-    fprintf(stderr, "Game pointer is null\n");
+    GAME_LOG(GAME_LOG_ERROR, "Game pointer is null");
     return;
   }
 
   if (filename == NULL) {
-    fprintf(stderr, "Filename is null\n");
+    GAME_LOG(GAME_LOG_ERROR, "Filename is null");
     return;
   }
 
   FILE* file = fopen(filename, "w");
   if (file == NULL) {
-    fprintf(stderr, "Failed to open the file: %s\n", filename);
+    GAME_LOG(GAME_LOG_ERROR, "Failed to open the file: %s", filename);
     return;
   }
 
-  fprintf(file, "%d %d %d\n", game_nb_rows(g), game_nb_cols(g),
-          game_is_wrapping(g));
-  for (int i = 0; i < game_nb_rows(g); i++) {
-    for (int j = 0; j < game_nb_cols(g); j++) {
-      shape s = g->shapes[i * game_nb_cols(g) + j];
-      direction d = g->orientations[i * game_nb_cols(g) + j];
+  fprintf(file, "%u %u %d\n", _game_nb_rows(g), _game_nb_cols(g),
+          _game_is_wrapping(g));
+  for (uint i = 0; i < _game_nb_rows(g); i++) {
+    for (uint j = 0; j < _game_nb_cols(g); j++) {
+      cell c = g->cells[_game_index(g, i, j)];
+      shape s = _cell_shape(c);
+      direction d = CELL_ORIENTATION(c);
       fprintf(file, "%c%c ", shape_to_char(s), direction_to_char(d));
     }
-    if (i == game_nb_rows(g) - 1) {
+    if (i == _game_nb_rows(g) - 1) {
       fprintf(file, " ");
     } else {
       fprintf(file, "\n");
@@ -167,83 +180,65 @@ void game_save(cgame g, char* filename) {
 
 game game_random(uint nb_rows, uint nb_cols, bool wrapping, uint nb_empty,
                  uint nb_extra) {
+  // Générateur global de la bibliothèque standard
+  return game_random_r(nb_rows, nb_cols, wrapping, nb_empty, nb_extra, NULL);
+}
+
+game game_random_r(uint nb_rows, uint nb_cols, bool wrapping, uint nb_empty,
+                   uint nb_extra, uint64_t* rng) {
   game g = game_new_empty_ext(nb_rows, nb_cols, wrapping);
   if (g == NULL) {
     return NULL;
   }
 
-  // Placement aléatoire d'un jeu solution à 2 pièces
-  uint i = rand() % nb_rows;
-  uint j = rand() % nb_cols;
-  bool vertical = rand() % 2;
+  // Placement aléatoire d'un jeu solution à 2 pièces, construit comme le reste
+  // de la grille par ses masques de demi-arêtes
+  uint i = _rng_below(rng, nb_rows);
+  uint j = _rng_below(rng, nb_cols);
+  bool vertical = _rng_below(rng, 2);
 
   if (vertical) {
     if (i == nb_rows - 1) {
       i--;  // Ajustement pour éviter de dépasser les limites
     }
-    game_set_piece_shape(g, i, j, ENDPOINT);
-    game_set_piece_shape(g, i + 1, j, ENDPOINT);
-    game_set_piece_orientation(g, i, j, SOUTH);
-    game_set_piece_orientation(g, i + 1, j, NORTH);
+    game_set_piece_mask(g, i, j, DIR_BIT(SOUTH));
+    game_set_piece_mask(g, i + 1, j, DIR_BIT(NORTH));
   } else {
     if (j == nb_cols - 1) {
       j--;  // Ajustement pour éviter de dépasser les limites
     }
-    game_set_piece_shape(g, i, j, ENDPOINT);
-    game_set_piece_shape(g, i, j + 1, ENDPOINT);
-    game_set_piece_orientation(g, i, j, EAST);
-    game_set_piece_orientation(g, i, j + 1, WEST);
+    game_set_piece_mask(g, i, j, DIR_BIT(EAST));
+    game_set_piece_mask(g, i, j + 1, DIR_BIT(WEST));
   }
 
-  // Allouer dynamiquement le tableau 'visited' avec calloc
-  bool** visited = (bool**)calloc(nb_rows, sizeof(bool*));
+  // Cases déjà reliées à l'arbre, en un seul tableau indexé comme les cases
+  bool* visited = calloc(_game_size(g), sizeof(bool));
   if (!visited) {
-    perror("Erreur d'allocation mémoire pour visited");
+    GAME_LOG(GAME_LOG_ERROR, "Erreur d'allocation mémoire pour visited");
     game_delete(g);
     exit(EXIT_FAILURE);
   }
-  for (uint row = 0; row < nb_rows; ++row) {
-    visited[row] = (bool*)calloc(nb_cols, sizeof(bool));
-    if (!visited[row]) {
-      perror("Erreur d'allocation mémoire pour visited[row]");
-      for (uint r = 0; r < row; ++r) {
-        free(visited[r]);
-      }
-      free(visited);
-      game_delete(g);
-      exit(EXIT_FAILURE);
-    }
-  }
 
   // Marquer les deux premières pièces comme visitées
-  visited[i][j] = true;
-  if (vertical) {
-    visited[i + 1][j] = true;
-  } else {
-    visited[i][j + 1] = true;
-  }
+  size_t first = _game_index(g, i, j);
+  visited[first] = true;
+  visited[_game_neighbor(g, first, vertical ? SOUTH : EAST)] = true;
 
   // Croître l'arbre couvrant en remplissant toute la grille
-  uint current_pieces = 2;
-  uint total_pieces = nb_rows * nb_cols - nb_empty;
+  size_t current_pieces = 2;
+  size_t total_pieces = (size_t)nb_rows * nb_cols - nb_empty;
 
   while (current_pieces < total_pieces) {
-    uint i_candidate = rand() % nb_rows;
-    uint j_candidate = rand() % nb_cols;
-    if (visited[i_candidate][j_candidate]) {
-      direction d = rand() % NB_DIRS;
-      int ni = i_candidate + (d == NORTH ? -1 : d == SOUTH ? 1 : 0);
-      int nj = j_candidate + (d == WEST ? -1 : d == EAST ? 1 : 0);
-
-      if (wrapping) {
-        ni = (ni + nb_rows) % nb_rows;
-        nj = (nj + nb_cols) % nb_cols;
-      }
-
-      if (ni >= 0 && ni < nb_rows && nj >= 0 && nj < nb_cols &&
-          !visited[ni][nj]) {
-        if (_add_edge(g, i_candidate, j_candidate, d)) {
-          visited[ni][nj] = true;
+    uint i_candidate = _rng_below(rng, nb_rows);
+    uint j_candidate = _rng_below(rng, nb_cols);
+    size_t candidate = _game_index(g, i_candidate, j_candidate);
+    if (visited[candidate]) {
+      direction d = _rng_below(rng, NB_DIRS);
+      size_t next = _game_neighbor(g, candidate, d);
+
+      if (next != NO_NEIGHBOR && !visited[next]) {
+        if (_add_edge_at(g, candidate, d)) {
+          visited[next] = true;
           current_pieces++;
         }
       }
@@ -253,14 +248,14 @@ game game_random(uint nb_rows, uint nb_cols, bool wrapping, uint nb_empty,
   // Ajouter des arêtes supplémentaires pour créer des cycles
   uint extra_edges_added = 0;
   while (extra_edges_added < nb_extra) {
-    uint i_candidate = rand() % nb_rows;
-    uint j_candidate = rand() % nb_cols;
-    direction d = rand() % NB_DIRS;
-
-    if (game_check_edge(g, i_candidate, j_candidate, d) == NOEDGE) {
-      if (_add_edge(g, i_candidate, j_candidate, d)) {
-        extra_edges_added++;
-      }
+    uint i_candidate = _rng_below(rng, nb_rows);
+    uint j_candidate = _rng_below(rng, nb_cols);
+    direction d = _rng_below(rng, NB_DIRS);
+
+    // Ajout seulement si aucune des deux demi-arêtes n'existe
+    size_t candidate = _game_index(g, i_candidate, j_candidate);
+    if (_add_edge_at(g, candidate, d)) {
+      extra_edges_added++;
     }
   }
 
@@ -268,17 +263,14 @@ game game_random(uint nb_rows, uint nb_cols, bool wrapping, uint nb_empty,
   for (uint k = 0; k < nb_empty; k++) {
     uint empty_i, empty_j;
     do {
-      empty_i = rand() % nb_rows;
-      empty_j = rand() % nb_cols;
-    } while (game_get_piece_shape(g, empty_i, empty_j) != EMPTY);
+      empty_i = _rng_below(rng, nb_rows);
+      empty_j = _rng_below(rng, nb_cols);
+    } while (_game_get_piece_shape(g, empty_i, empty_j) != EMPTY);
 
     game_set_piece_shape(g, empty_i, empty_j, EMPTY);
   }
 
   // Libérer la mémoire allouée pour 'visited'
-  for (uint row = 0; row < nb_rows; ++row) {
-    free(visited[row]);
-  }
   free(visited);
 
   return g;
@@ -286,18 +278,18 @@ game game_random(uint nb_rows, uint nb_cols, bool wrapping, uint nb_empty,
 
 static bool solve_recc(game g, uint row, uint col) {
   if (g == NULL) {
-    fprintf(stderr, "Game pointer is null\n");
+    GAME_LOG(GAME_LOG_ERROR, "Game pointer is null");
     return false;
   }
 
   // Si on a parcouru toute la grille, on teste si la solution est valide
-  if (row >= game_nb_rows(g)) return game_won(g);
+  if (row >= _game_nb_rows(g)) return game_won(g);
 
   // Calcul des indices pour la case suivante
-  uint next_row = (col + 1 >= game_nb_cols(g)) ? row + 1 : row;
-  uint next_col = (col + 1) % game_nb_cols(g);
+  uint next_row = (col + 1 >= _game_nb_cols(g)) ? row + 1 : row;
+  uint next_col = (col + 1) % _game_nb_cols(g);
 
-  shape sh = game_get_piece_shape(g, row, col);
+  shape sh = _game_get_piece_shape(g, row, col);
   // Si la pièce est EMPTY ou CROSS, on passe directement à la suivante
   if (sh == EMPTY || sh == CROSS) {
     return solve_recc(g, next_row, next_col);
@@ -306,17 +298,18 @@ static bool solve_recc(game g, uint row, uint col) {
   // Pour SEGMENT, seules 2 orientations sont possibles, sinon NB_DIRS
   uint max_dir = (sh == SEGMENT) ? 2 : NB_DIRS;
 
+  size_t index = _game_index(g, row, col);
   for (uint d = 0; d < max_dir; ++d) {
-    game_set_piece_orientation(g, row, col, d);
+    _game_set_cell(g, index, _cell_encode(sh, d));
 
     // Cas sans wrapping
-    if (!game_is_wrapping(g)) {
+    if (!_game_is_wrapping(g)) {
       // Vérifie la connexion à l'ouest (sauf si en 1ère colonne)
-      if (col > 0 && game_check_edge(g, row, col, WEST) == MISMATCH) {
+      if (col > 0 && _game_check_edge(g, index, WEST) == MISMATCH) {
         continue;  // Si mismatch, essayer la prochaine orientation
       }
       // Vérifie la connexion au nord (sauf si en 1ère ligne)
-      if (row > 0 && game_check_edge(g, row, col, NORTH) == MISMATCH) {
+      if (row > 0 && _game_check_edge(g, index, NORTH) == MISMATCH) {
         continue;  // Si mismatch, essayer la prochaine orientation
       }
     }
@@ -324,12 +317,12 @@ static bool solve_recc(game g, uint row, uint col) {
     else {
       // Si on est dans la première colonne, on ignore le test de connexion à
       // l'ouest
-      if (col != 0 && game_check_edge(g, row, col, WEST) == MISMATCH) {
+      if (col != 0 && _game_check_edge(g, index, WEST) == MISMATCH) {
         continue;  // Si mismatch, essayer la prochaine orientation
       }
       // Si on est dans la première ligne, on ignore le test de connexion au
       // nord
-      if (row != 0 && game_check_edge(g, row, col, NORTH) == MISMATCH) {
+      if (row != 0 && _game_check_edge(g, index, NORTH) == MISMATCH) {
         continue;  // Si mismatch, essayer la prochaine orientation
       }
     }
@@ -341,45 +334,104 @@ static bool solve_recc(game g, uint row, uint col) {
   return false;  // Si aucune orientation ne permet de trouver une solution
 }
 
-bool game_solve(game g) {
-  game g_copy = game_copy(g);  // Sauvegarde de l'état initial
-
-  bool solved = solve_recc(g, 0, 0);
-  if (!solved) {
-    // Restaurer l'état initial si aucune solution n'a été trouvée
-    for (uint row = 0; row < game_nb_rows(g); row++) {
-      for (uint col = 0; col < game_nb_cols(g); col++) {
-        game_set_piece_orientation(
-            g, row, col, game_get_piece_orientation(g_copy, row, col));
-      }
+/* Même recherche pour une grille N x N rangée ligne par ligne, la case k étant
+ * (k / N, k % N) : divisions par une constante, voisins ouest et nord lus
+ * directement aux pas 1 et N. Les cases sont écrites sans mise à jour des
+ * compteurs, recalculés en bloc quand la grille est complète. */
+#define DEFINE_SOLVE(N)                                                    \
+  static bool _solve_##N(game g, uint k) {                                 \
+    if (k == N * N) {                                                      \
+      _game_refresh(g);                                                    \
+      return game_won(g);                                                  \
+    }                                                                      \
+    cell *cells = g->cells;                                                \
+    shape sh = _cell_shape(cells[k]);                                      \
+    if (sh == EMPTY || sh == CROSS) return _solve_##N(g, k + 1);           \
+    uint max_dir = (sh == SEGMENT) ? 2 : NB_DIRS;                          \
+    for (uint d = 0; d < max_dir; ++d) {                                   \
+      cells[k] = _cell_encode(sh, d);                                      \
+      /* Une seule demi-arête entre la case et son voisin : mismatch */    \
+      if (k % N != 0 && ((cells[k] ^ (cells[k - 1] >> 2)) & 1)) continue;  \
+      if (k >= N && (((cells[k] >> 2) ^ cells[k - N]) >> 1) & 1) continue; \
+      if (_solve_##N(g, k + 1)) return true;                               \
+    }                                                                      \
+    return false;                                                          \
+  }
+
+FIXED_SIZES(DEFINE_SOLVE)
+
+// Recherche adaptée à la taille de la grille
+static bool _solve(game g) {
+  if (g->nb_rows == g->nb_cols && g->tile_cols == 0) {
+#define SOLVE_CASE(N) \
+  case N:             \
+    return _solve_##N(g, 0);
+    switch (g->nb_cols) {
+      FIXED_SIZES(SOLVE_CASE)
+      default:
+        break;
     }
+#undef SOLVE_CASE
   }
+  return solve_recc(g, 0, 0);
+}
 
-  game_delete(g_copy);
+bool game_solve(game g) {
+  if (g == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Null game pointer");
+    exit(EXIT_FAILURE);
+  }
+
+  // Sauvegarde des orientations initiales seulement, taille calculée en size_t
+  // comme pour game_memory_size
+  size_t size = _game_size(g);
+  if (size > SIZE_MAX / sizeof(direction)) {
+    GAME_LOG(GAME_LOG_ERROR, "Game too large to save its orientations");
+    return false;
+  }
+  direction* saved = malloc(size * sizeof(direction));
+  if (saved == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to save orientations");
+    return false;
+  }
+  game_save_orientations(g, saved);
+
+  record* r = _game_write_begin(g, 0, true);
+  bool solved = _solve(g);
+  if (solved) {
+    // La solution est annulée avec le dernier coup, comme les autres écritures
+    _game_write_end(g, r);
+  } else {
+    // Restaurer l'état initial si aucune solution n'a été trouvée, sans rien
+    // ajouter à l'historique
+    _game_write_orientations(g, saved);
+    free(r);
+  }
+
+  free(saved);
   return solved;
 }
 
 static void count_sol_recc(game g, uint num_row, uint num_col,
                            uint* sol_count) {
   if (g == NULL) {
-    fprintf(stderr, "Game pointer is null\n");
+    GAME_LOG(GAME_LOG_ERROR, "Game pointer is null");
     exit(EXIT_FAILURE);
   }
 
-  if (num_row >= game_nb_rows(g)) {
-    // Si on a trouvé une solution, on incrémente le compteur et on affiche la
-    // solution
+  if (num_row >= _game_nb_rows(g)) {
+    // Si on a trouvé une solution, on incrémente le compteur
     if (game_won(g)) {
       (*sol_count)++;
-      game_print(g);
+      GAME_LOG(GAME_LOG_DEBUG, "Solution %u found", *sol_count);
     }
     return;
   }
 
-  uint next_row = (num_col + 1 >= game_nb_cols(g)) ? num_row + 1 : num_row;
-  uint next_col = (num_col + 1) % game_nb_cols(g);
+  uint next_row = (num_col + 1 >= _game_nb_cols(g)) ? num_row + 1 : num_row;
+  uint next_col = (num_col + 1) % _game_nb_cols(g);
 
-  shape current_shape = game_get_piece_shape(g, num_row, num_col);
+  shape current_shape = _game_get_piece_shape(g, num_row, num_col);
   // Si la pièce est EMPTY ou CROSS, on passe directement à la suivante
   if (current_shape == EMPTY || current_shape == CROSS) {
     return count_sol_recc(g, next_row, next_col, sol_count);
@@ -389,24 +441,25 @@ static void count_sol_recc(game g, uint num_row, uint num_col,
   uint max_directions = (current_shape == SEGMENT) ? 2 : NB_DIRS;
 
   // On teste chaque orientation et passe à la case suivante
+  size_t index = _game_index(g, num_row, num_col);
   for (uint d = 0; d < max_directions; ++d) {
-    game_set_piece_orientation(g, num_row, num_col, d);
+    _game_set_cell(g, index, _cell_encode(current_shape, d));
 
     // On s'arrête s'il y a un mismatch à l'ouest ou au nord
-    if (!game_is_wrapping(g)) {
-      if (game_check_edge(g, num_row, num_col, WEST) != MISMATCH &&
-          game_check_edge(g, num_row, num_col, NORTH) != MISMATCH) {
+    if (!_game_is_wrapping(g)) {
+      if (_game_check_edge(g, index, WEST) != MISMATCH &&
+          _game_check_edge(g, index, NORTH) != MISMATCH) {
         // Pas de mismatch, on continue
         count_sol_recc(g, next_row, next_col, sol_count);
       }
     } else {
       // Cas avec wrapping
-      if ((num_row == 0 || num_row == game_nb_rows(g) - 1) &&
-          (num_col == 0 || num_col == game_nb_cols(g) - 1)) {
+      if ((num_row == 0 || num_row == _game_nb_rows(g) - 1) &&
+          (num_col == 0 || num_col == _game_nb_cols(g) - 1)) {
         count_sol_recc(g, next_row, next_col, sol_count);
       } else {
-        if (game_check_edge(g, num_row, num_col, WEST) != MISMATCH &&
-            game_check_edge(g, num_row, num_col, NORTH) != MISMATCH) {
+        if (_game_check_edge(g, index, WEST) != MISMATCH &&
+            _game_check_edge(g, index, NORTH) != MISMATCH) {
           // Pas de mismatch, on continue
           count_sol_recc(g, next_row, next_col, sol_count);
         }
@@ -421,19 +474,12 @@ uint game_nb_solutions(cgame g) {
   game g_copy = game_copy(g);
 
   if (!g_copy) {
-    fprintf(stderr, "Failed to copy game\n");
+    GAME_LOG(GAME_LOG_ERROR, "Failed to copy game");
     return 0;
   }
 
+  // La recherche se fait sur la copie, g n'est jamais modifié
   count_sol_recc(g_copy, 0, 0, &sol_count);
-  if (sol_count == 0) {
-    for (uint row = 0; row < game_nb_rows(g); row++) {
-      for (uint col = 0; col < game_nb_cols(g); col++) {
-        game_set_piece_orientation(g_copy, row, col,
-                                   game_get_piece_orientation(g, row, col));
-      }
-    }
-  }
 
   game_delete(g_copy);
   return sol_count;
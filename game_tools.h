@@ -9,6 +9,7 @@
 #ifndef __GAME_TOOLS_H__
 #define __GAME_TOOLS_H__
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #include "game.h"
@@ -80,6 +81,24 @@ void game_save(cgame g, char* filename);
 
 game game_random(uint nb_rows, uint nb_cols, bool wrapping, uint nb_empty,
                  uint nb_extra);
+
+/**
+ * @brief Creates a random game solution, with a given generator.
+ * @details Same as @ref game_random, but the random numbers are drawn from the
+ * generator whose state is @p rng, so that several threads can generate games
+ * concurrently and reproducibly.
+ * @param nb_rows number of rows in game
+ * @param nb_cols number of columns in game
+ * @param wrapping wrapping option
+ * @param nb_empty number of empty squares
+ * @param nb_extra number of extra edges, that make cycles (if possible)
+ * @param rng the state of the generator, initialized with any seed and updated
+ * by the call, or NULL to use rand() as @ref game_random
+ * @pre same as @ref game_random
+ * @return the generated random game (or NULL in case of error)
+ */
+game game_random_r(uint nb_rows, uint nb_cols, bool wrapping, uint nb_empty,
+                   uint nb_extra, uint64_t* rng);
 /**
  * @brief Computes the solution of a given game.
  * @param g the game to solve
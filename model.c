@@ -10,6 +10,7 @@
 #include "game.h"
 #include "game_aux.h"
 #include "game_ext.h"
+#include "game_inline.h"
 #include "game_struct.h"
 #include "game_tools.h"
 
@@ -115,7 +116,7 @@ void button_game_default(Env *env) {
 
 void button_game_solve(Env *env) {
   printf("Solving game... \n");
-  game_solve(env->g);
+  // game_solve laisse le jeu inchangé s'il n'y a pas de solution
   if (game_solve(env->g)) {
     printf("Game solved !\n");
   } else {
@@ -286,8 +287,10 @@ void render(SDL_Window *win, SDL_Renderer *ren, Env *env) {
   int grid_width = width - 2 * margin;
   int grid_height = height - top_bar_height - 2 * margin;
 
-  uint rows = game_nb_rows(env->g);
-  uint cols = game_nb_cols(env->g);
+  // Lecture directe des cases, sans appel par case
+  game_view view = game_cells_view(env->g);
+  uint rows = view.nb_rows;
+  uint cols = view.nb_cols;
   int cell_size = fmin(grid_width / cols, grid_height / rows);
 
   int offset_x = (width - (cell_size * cols)) / 2;
@@ -300,8 +303,16 @@ void render(SDL_Window *win, SDL_Renderer *ren, Env *env) {
       SDL_Rect cell = {offset_x + j * cell_size, offset_y + i * cell_size,
                        cell_size, cell_size};
 
-      shape s = game_get_piece_shape(env->g, i, j);
-      direction d = game_get_piece_orientation(env->g, i, j);
+      shape s;
+      direction d;
+      if (view.stride != 0) {
+        unsigned char c = view.cells[i * view.stride + j];
+        s = game_view_shape(c);
+        d = GAME_VIEW_ORIENTATION(c);
+      } else {
+        s = _game_get_piece_shape(env->g, i, j);
+        d = _game_get_piece_orientation(env->g, i, j);
+      }
 
       SDL_Texture *texture = NULL;
       switch (s) {
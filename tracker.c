@@ -0,0 +1,257 @@
+#include "tracker.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game.h"
+#include "game_log.h"
+#include "game_struct.h"
+
+/* *********************************************************** */
+
+#define NO_LABEL ((uint)-1)
+
+/* *********************************************************** */
+
+struct tracker_s {
+  uint nb_squares;
+  uint nb_components;
+  uint *label;        // component of each square, NO_LABEL if empty
+  uint *size;         // size of each component, indexed by label
+  uint *free_labels;  // stack of unused labels
+  uint nb_free;
+  uint *mark;  // marks of the searches, compared to epoch
+  uint epoch;
+  uint *queue_a;  // search queues
+  uint *queue_b;
+};
+
+/* *********************************************************** */
+
+static uint _alloc_label(tracker *t) {
+  assert(t->nb_free > 0);
+  uint l = t->free_labels[--t->nb_free];
+  t->size[l] = 0;
+  return l;
+}
+
+/* *********************************************************** */
+
+static void _free_label(tracker *t, uint l) {
+  t->free_labels[t->nb_free++] = l;
+}
+
+/* *********************************************************** */
+
+/* relabel with @p l all the squares labeled @p from that are reachable
+ * from @p start through well-matched edges, returns their number */
+static uint _flood(tracker *t, cgame g, uint start, uint from, uint l) {
+  uint head = 0, tail = 0;
+  t->label[start] = l;
+  t->queue_a[tail++] = start;
+  while (head < tail) {
+    uint c = t->queue_a[head++];
+    uint links = _game_links(g, c);
+    for (direction d = 0; d < NB_DIRS; d++) {
+      if (!(links & DIR_BIT(d))) continue;
+      uint n = _game_neighbor(g, c, d);
+      if (t->label[n] == from) {
+        t->label[n] = l;
+        t->queue_a[tail++] = n;
+      }
+    }
+  }
+  return tail;
+}
+
+/* *********************************************************** */
+
+static void _union(tracker *t, cgame g, uint x, uint y) {
+  uint lx = t->label[x], ly = t->label[y];
+  if (lx == ly) return;
+  // relabel the smallest component only
+  uint big = lx, small = ly, start = y;
+  if (t->size[lx] < t->size[ly]) {
+    big = ly;
+    small = lx;
+    start = x;
+  }
+  t->size[big] += _flood(t, g, start, small, big);
+  _free_label(t, small);
+  t->nb_components--;
+}
+
+/* *********************************************************** */
+
+/* x and y, with the same label, may have been disconnected by the removal of
+ * some edges: search both sides in turn, and split the component if the
+ * smallest side gets exhausted first, returns true in that case */
+static bool _split(tracker *t, cgame g, uint x, uint y) {
+  uint l = t->label[x];
+  assert(l == t->label[y]);
+
+  if (t->epoch >= NO_LABEL - 2) {
+    memset(t->mark, 0, t->nb_squares * sizeof(uint));
+    t->epoch = 0;
+  }
+  t->epoch += 2;
+  uint mark[2] = {t->epoch, t->epoch + 1};
+  uint *queue[2] = {t->queue_a, t->queue_b};
+  uint head[2] = {0, 0}, tail[2] = {1, 1};
+  t->mark[x] = mark[0];
+  t->mark[y] = mark[1];
+  queue[0][0] = x;
+  queue[1][0] = y;
+
+  for (uint side = 0;; side = 1 - side) {
+    if (head[side] == tail[side]) {
+      // this side is a whole component on its own
+      uint nl = _alloc_label(t);
+      for (uint k = 0; k < tail[side]; k++) t->label[queue[side][k]] = nl;
+      t->size[nl] = tail[side];
+      t->size[l] -= tail[side];
+      t->nb_components++;
+      return true;
+    }
+    uint c = queue[side][head[side]++];
+    uint links = _game_links(g, c);
+    for (direction d = 0; d < NB_DIRS; d++) {
+      if (!(links & DIR_BIT(d))) continue;
+      uint n = _game_neighbor(g, c, d);
+      if (t->label[n] != l) continue;  // merged later by a new edge
+      if (t->mark[n] == mark[1 - side]) return false;  // both sides meet
+      if (t->mark[n] != mark[side]) {
+        t->mark[n] = mark[side];
+        queue[side][tail[side]++] = n;
+      }
+    }
+  }
+}
+
+/* *********************************************************** */
+
+tracker *tracker_new(cgame g) {
+  assert(g);
+  // squares are indexed on 32 bits
+  if (_game_size(g) >= NO_LABEL) {
+    GAME_LOG(GAME_LOG_ERROR, "Game too large for connectivity tracking");
+    exit(EXIT_FAILURE);
+  }
+  tracker *t = malloc(sizeof(tracker));
+  if (t == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to allocate connectivity tracker");
+    exit(EXIT_FAILURE);
+  }
+  uint n = _game_size(g);
+  t->nb_squares = n;
+  t->label = malloc(n * sizeof(uint));
+  t->size = malloc(n * sizeof(uint));
+  t->free_labels = malloc(n * sizeof(uint));
+  t->mark = calloc(n, sizeof(uint));
+  t->queue_a = malloc(n * sizeof(uint));
+  t->queue_b = malloc(n * sizeof(uint));
+  if (t->label == NULL || t->size == NULL || t->free_labels == NULL ||
+      t->mark == NULL || t->queue_a == NULL || t->queue_b == NULL) {
+    GAME_LOG(GAME_LOG_ERROR, "Failed to allocate connectivity tracker");
+    exit(EXIT_FAILURE);
+  }
+  t->epoch = 0;
+  tracker_rebuild(t, g);
+  return t;
+}
+
+/* *********************************************************** */
+
+void tracker_rebuild(tracker *t, cgame g) {
+  assert(t);
+  assert(g);
+  t->nb_free = t->nb_squares;
+  for (uint k = 0; k < t->nb_squares; k++) {
+    t->label[k] = NO_LABEL;
+    t->free_labels[k] = t->nb_squares - 1 - k;
+  }
+  t->nb_components = 0;
+  for (uint k = 0; k < t->nb_squares; k++) {
+    if (CELL_MASK(g->cells[k]) != 0 && t->label[k] == NO_LABEL) {
+      uint l = _alloc_label(t);
+      t->size[l] = _flood(t, g, k, NO_LABEL, l);
+      t->nb_components++;
+    }
+  }
+}
+
+/* *********************************************************** */
+
+void tracker_update(tracker *t, cgame g, uint index, uint old_mask,
+                    uint old_links, uint new_links) {
+  assert(t);
+  assert(g);
+  assert(index < t->nb_squares);
+  uint new_mask = CELL_MASK(g->cells[index]);
+
+  // a square that is no longer empty starts as a component of its own
+  if (old_mask == 0 && new_mask != 0) {
+    uint l = _alloc_label(t);
+    t->label[index] = l;
+    t->size[l] = 1;
+    t->nb_components++;
+  }
+
+  // every square of the component is still connected to one of the ends of
+  // the removed edges: check that ends sharing a label are still connected
+  uint removed = old_links & ~new_links;
+  uint added = new_links & ~old_links;
+  uint ends[NB_DIRS + 1] = {index};
+  uint nb_ends = 1;
+  for (direction d = 0; d < NB_DIRS; d++) {
+    uint n = _game_neighbor(g, index, d);
+    if (!(removed & DIR_BIT(d)) || n == index) continue;
+    bool known = false;  // same neighbor through two parallel edges
+    for (uint k = 0; k < nb_ends; k++) known = known || (ends[k] == n);
+    if (known) continue;
+    for (uint k = 0; k < nb_ends; k++) {
+      if (t->label[ends[k]] == t->label[n] && !_split(t, g, ends[k], n)) {
+        break;  // still connected to the ends checked before
+      }
+    }
+    ends[nb_ends++] = n;
+  }
+  for (direction d = 0; d < NB_DIRS; d++) {
+    uint n = _game_neighbor(g, index, d);
+    if ((added & DIR_BIT(d)) && n != index) _union(t, g, index, n);
+  }
+
+  // an empty square has no edge left, so it is alone in its component
+  if (old_mask != 0 && new_mask == 0) {
+    uint l = t->label[index];
+    assert(t->size[l] == 1);
+    _free_label(t, l);
+    t->label[index] = NO_LABEL;
+    t->nb_components--;
+  }
+}
+
+/* *********************************************************** */
+
+uint tracker_nb_components(const tracker *t) {
+  assert(t);
+  return t->nb_components;
+}
+
+/* *********************************************************** */
+
+void tracker_free(tracker *t) {
+  if (t == NULL) return;
+  free(t->label);
+  free(t->size);
+  free(t->free_labels);
+  free(t->mark);
+  free(t->queue_a);
+  free(t->queue_b);
+  free(t);
+}
+
+/* *********************************************************** */
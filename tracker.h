@@ -0,0 +1,66 @@
+/**
+ * @file tracker.h
+ * @brief Incremental connectivity tracker.
+ * @details Maintains the connected components of the network formed by the
+ * well-matched edges of a game while its squares are modified one at a time.
+ * An edge insertion merges two components by relabeling the smaller one. An
+ * edge deletion runs two interleaved searches from both ends of the edge, so
+ * that the cost is bounded by the size of the smaller side when the component
+ * splits.
+ * @copyright University of Bordeaux. All rights reserved, 2024.
+ **/
+
+#ifndef __TRACKER_H__
+#define __TRACKER_H__
+
+#include <stdbool.h>
+
+#include "game.h"
+
+/**
+ * @brief Opaque structure representing a connectivity tracker.
+ */
+typedef struct tracker_s tracker;
+
+/**
+ * @brief Creates a tracker and computes the components of a game.
+ * @param g the game
+ * @return the created tracker
+ */
+tracker *tracker_new(cgame g);
+
+/**
+ * @brief Recomputes all the components from scratch.
+ * @details To be called after a bulk modification of the squares.
+ * @param t the tracker
+ * @param g the game
+ */
+void tracker_rebuild(tracker *t, cgame g);
+
+/**
+ * @brief Updates the components after a single square has been written.
+ * @param t the tracker
+ * @param g the game, already holding the new value of the square
+ * @param index index of the modified square
+ * @param old_mask half-edge mask of the square before the write
+ * @param old_links directions of the well-matched edges before the write (one
+ * bit per direction, see DIR_BIT)
+ * @param new_links directions of the well-matched edges after the write
+ */
+void tracker_update(tracker *t, cgame g, uint index, uint old_mask,
+                    uint old_links, uint new_links);
+
+/**
+ * @brief Gets the number of connected components.
+ * @param t the tracker
+ * @return the number of components made of non-empty squares
+ */
+uint tracker_nb_components(const tracker *t);
+
+/**
+ * @brief Frees the memory allocated for the tracker.
+ * @param t the tracker
+ */
+void tracker_free(tracker *t);
+
+#endif  // __TRACKER_H__
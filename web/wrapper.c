@@ -28,6 +28,13 @@ void play_move(game g, uint i, uint j, int nb_quarter_turns) {
   game_play_move(g, i, j, nb_quarter_turns);
 }
 
+EMSCRIPTEN_KEEPALIVE
+bool play_moves(game g, const move *moves, uint nb_moves, bool grouped) {
+  bool won = false;
+  game_play_moves(g, moves, nb_moves, grouped, &won);
+  return won;
+}
+
 EMSCRIPTEN_KEEPALIVE
 void restart(game g) { game_shuffle_orientation(g); }
 
@@ -50,6 +57,19 @@ uint nb_rows(cgame g) { return game_nb_rows(g); }
 EMSCRIPTEN_KEEPALIVE
 uint nb_cols(cgame g) { return game_nb_cols(g); }
 
+EMSCRIPTEN_KEEPALIVE
+const unsigned char *cells(cgame g) { return game_cells_view(g).cells; }
+
+EMSCRIPTEN_KEEPALIVE
+uint cells_stride(cgame g) { return game_cells_view(g).stride; }
+
+EMSCRIPTEN_KEEPALIVE
+shape view_shape(unsigned char c) { return game_view_shape(c); }
+
+// Compteur 64 bits rendu en nombre JavaScript, exact jusqu'à 2^53 changements
+EMSCRIPTEN_KEEPALIVE
+double generation(cgame g) { return (double)game_generation(g); }
+
 EMSCRIPTEN_KEEPALIVE
 edge_status check_edge(cgame g, uint i, uint j, direction d) {
   return game_check_edge(g, i, j, d);